@@ -0,0 +1,39 @@
+#include "helpers/alloc_tracking.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+
+// Google Benchmark runs every benchmark once more between Start and Stop, and
+// adds the heap use of that run to the console and JSON output
+namespace {
+    class AllocationManager : public benchmark::MemoryManager {
+    public:
+        void Start() override {
+            setAllocationTracking(true);
+            scope = std::make_unique<AllocationScope>();
+        }
+
+        void Stop(Result& result) override {
+            const AllocationTotals totals = scope->totals();
+            scope.reset();
+            setAllocationTracking(false);
+            result.num_allocs = static_cast<int64_t>(totals.allocations);
+            result.total_allocated_bytes = static_cast<int64_t>(totals.bytes);
+            result.max_bytes_used = static_cast<int64_t>(totals.peak_bytes);
+        }
+
+    private:
+        std::unique_ptr<AllocationScope> scope;
+    };
+}
+
+// Same as benchmark_main, plus the allocation tracking run
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {return 1;}
+    AllocationManager allocations;
+    benchmark::RegisterMemoryManager(&allocations);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::RegisterMemoryManager(nullptr);
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "bench_support.hpp"
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <utility>
+
+constexpr static int FRAME_WIDTH_RATIO = 16;
+constexpr static int FRAME_HEIGHT_RATIO = 9;
+constexpr static double PIXELS_PER_MEGAPIXEL = 1e6;
+
+namespace {
+    const std::vector<int64_t> WIDTHS = {640, 1920, 3840};  // 360p, 1080p and 2160p frames
+    const std::vector<int64_t> DISTRIBUTIONS = {static_cast<int64_t>(ColorDistribution::noise),
+                                                static_cast<int64_t>(ColorDistribution::palette),
+                                                static_cast<int64_t>(ColorDistribution::gradient)};
+
+    int frame_height(const int width) {
+        return width * FRAME_HEIGHT_RATIO / FRAME_WIDTH_RATIO;
+    }
+}
+
+void image_arguments(benchmark::internal::Benchmark* bench, const std::string& option_name,
+                     const std::vector<int64_t>& options) {
+    std::vector<std::vector<int64_t>> product = {WIDTHS, DISTRIBUTIONS};
+    std::vector<std::string> names = {"width", "distribution"};
+    if (!options.empty()) {
+        product.push_back(options);
+        names.push_back(option_name);
+    }
+    bench->ArgsProduct(product)->ArgNames(names)->Unit(benchmark::kMillisecond);
+}
+
+template <typename Channel>
+const BasicImage<Channel>& bench_image(benchmark::State& state) {
+    static std::map<std::pair<int64_t, int64_t>, BasicImage<Channel>> images;
+    const std::pair<int64_t, int64_t> key = {state.range(0), state.range(1)};
+    const auto distribution = static_cast<ColorDistribution>(key.second);
+    state.SetLabel(std::string(distribution_name(distribution)) + (sizeof(Channel) == 1 ? " 8-bit" : " 16-bit"));
+    auto found = images.find(key);
+    if (found == images.end()) {
+        const auto width = static_cast<int>(key.first);
+        found = images.emplace(key, synthetic_image<Channel>(width, frame_height(width), std::numeric_limits<Channel>::max(), distribution)).first;
+    }
+    return found->second;
+}
+
+void set_megapixel_rate(benchmark::State& state, const int width, const int height) {
+    const double megapixels = static_cast<double>(width) * static_cast<double>(height) / PIXELS_PER_MEGAPIXEL;
+    state.counters["MP/s"] = benchmark::Counter(megapixels, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+std::string bench_file(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+template const BasicImage<uint8_t>& bench_image(benchmark::State& state);
+template const BasicImage<uint16_t>& bench_image(benchmark::State& state);
@@ -0,0 +1,26 @@
+#ifndef BENCH_SUPPORT_HPP
+#define BENCH_SUPPORT_HPP
+
+#include "synthetic_image.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Every image benchmark takes the arguments {width, distribution} followed
+// by the values of its own option, if any; the height keeps a 16:9 frame
+void image_arguments(benchmark::internal::Benchmark* bench, const std::string& option_name = "",
+                     const std::vector<int64_t>& options = {});
+
+// The synthetic image selected by the first two arguments, at the full range
+// of the channel type. Images are generated once per process and shared.
+template <typename Channel>
+const BasicImage<Channel>& bench_image(benchmark::State& state);
+
+// Reports the rate at which images of this size were processed as "MP/s"
+void set_megapixel_rate(benchmark::State& state, int width, int height);
+
+// Scratch file in the temporary directory for the I/O benchmarks
+std::string bench_file(const std::string& name);
+
+#endif // BENCH_SUPPORT_HPP
@@ -0,0 +1,95 @@
+#include "bench_support.hpp"
+#include "common/image_layout.hpp"
+#include "common/tiled_image.hpp"
+#include "imgaos/imageaos.hpp"
+#include "imgsoa/imagesoa.hpp"
+#include <cstdint>
+
+// The same operations on every layout policy (common/image_layout.hpp), so
+// the layouts are compared through one code path. Conversions to and from
+// the interleaved image happen outside the timed loop, and are timed on
+// their own by BM_ToLayout and BM_FromLayout.
+
+namespace {
+    // The third argument is the ResizeMethod; the image is halved in both directions
+    template <ImageLayout Layout, typename Channel>
+    void BM_Resize(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const LayoutImage<Layout, Channel> source = Layout::from_interleaved(image);
+        const auto method = static_cast<ResizeMethod>(state.range(2));
+        for (auto _ : state) {benchmark::DoNotOptimize(Layout::resize(source, image.width / 2, image.height / 2, method));}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    // The third argument is the cutfreq threshold. cutfreq works in place, so
+    // every iteration restores the source untimed.
+    template <ImageLayout Layout, typename Channel>
+    void BM_Cutfreq(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const LayoutImage<Layout, Channel> source = Layout::from_interleaved(image);
+        for (auto _ : state) {
+            state.PauseTiming();
+            LayoutImage<Layout, Channel> converted = source;
+            state.ResumeTiming();
+            Layout::cutfreq(converted, static_cast<int>(state.range(2)));
+            benchmark::DoNotOptimize(converted);
+        }
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    template <ImageLayout Layout, typename Channel>
+    void BM_ToLayout(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        for (auto _ : state) {benchmark::DoNotOptimize(Layout::from_interleaved(image));}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    template <ImageLayout Layout, typename Channel>
+    void BM_FromLayout(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const LayoutImage<Layout, Channel> source = Layout::from_interleaved(image);
+        for (auto _ : state) {benchmark::DoNotOptimize(Layout::to_interleaved(source, image.max_color_value));}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    // Area and Lanczos-3 run on every layout, along with the layout's own
+    // default (nearest for AOS and tiled, bilinear for SOA)
+    template <ImageLayout Layout>
+    void resize_methods(benchmark::internal::Benchmark* bench) {
+        image_arguments(bench, "method", {static_cast<int64_t>(Layout::DEFAULT_RESIZE), static_cast<int64_t>(ResizeMethod::area),
+                                            static_cast<int64_t>(ResizeMethod::lanczos3)});
+    }
+
+    void cutfreq_thresholds(benchmark::internal::Benchmark* bench) {
+        image_arguments(bench, "threshold", {1, 1000});  // One color, or thousands of them for the noise images
+    }
+
+    void image_sizes(benchmark::internal::Benchmark* bench) {
+        image_arguments(bench);
+    }
+}
+
+BENCHMARK_TEMPLATE2(BM_Resize, AosLayout, uint8_t)->Apply(resize_methods<AosLayout>);
+BENCHMARK_TEMPLATE2(BM_Resize, AosLayout, uint16_t)->Apply(resize_methods<AosLayout>);
+BENCHMARK_TEMPLATE2(BM_Resize, SoaLayout, uint8_t)->Apply(resize_methods<SoaLayout>);
+BENCHMARK_TEMPLATE2(BM_Resize, SoaLayout, uint16_t)->Apply(resize_methods<SoaLayout>);
+BENCHMARK_TEMPLATE2(BM_Resize, TiledLayout, uint8_t)->Apply(resize_methods<TiledLayout>);
+BENCHMARK_TEMPLATE2(BM_Resize, TiledLayout, uint16_t)->Apply(resize_methods<TiledLayout>);
+BENCHMARK_TEMPLATE2(BM_Cutfreq, AosLayout, uint8_t)->Apply(cutfreq_thresholds);
+BENCHMARK_TEMPLATE2(BM_Cutfreq, AosLayout, uint16_t)->Apply(cutfreq_thresholds);
+BENCHMARK_TEMPLATE2(BM_Cutfreq, SoaLayout, uint8_t)->Apply(cutfreq_thresholds);
+BENCHMARK_TEMPLATE2(BM_Cutfreq, SoaLayout, uint16_t)->Apply(cutfreq_thresholds);
+BENCHMARK_TEMPLATE2(BM_Cutfreq, TiledLayout, uint8_t)->Apply(cutfreq_thresholds);
+BENCHMARK_TEMPLATE2(BM_Cutfreq, TiledLayout, uint16_t)->Apply(cutfreq_thresholds);
+BENCHMARK_TEMPLATE2(BM_ToLayout, AosLayout, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_ToLayout, AosLayout, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_ToLayout, SoaLayout, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_ToLayout, SoaLayout, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_ToLayout, TiledLayout, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_ToLayout, TiledLayout, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_FromLayout, AosLayout, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_FromLayout, AosLayout, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_FromLayout, SoaLayout, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_FromLayout, SoaLayout, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_FromLayout, TiledLayout, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE2(BM_FromLayout, TiledLayout, uint16_t)->Apply(image_sizes);
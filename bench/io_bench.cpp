@@ -0,0 +1,85 @@
+#include "bench_support.hpp"
+#include "common/binaryio.hpp"
+#include "common/compress.hpp"
+#include <cstdint>
+
+// PPM and CPPM encode and decode. The readers get a file written once before
+// the timed loop, so the page cache holds it and the numbers measure parsing.
+
+namespace {
+    template <typename Channel>
+    void BM_WritePpm(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const std::string path = bench_file("imtool_bench_write.ppm");
+        for (auto _ : state) {write_ppm(path, image);}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    // read_ppm always widens to 16-bit channels
+    template <typename Channel>
+    void BM_ReadPpm(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const std::string path = bench_file("imtool_bench_read.ppm");
+        write_ppm(path, image);
+        for (auto _ : state) {benchmark::DoNotOptimize(read_ppm(path));}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    template <typename Channel>
+    void BM_ReadPpmNative(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const std::string path = bench_file("imtool_bench_read.ppm");
+        write_ppm(path, image);
+        for (auto _ : state) {benchmark::DoNotOptimize(read_ppm_native(path));}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    template <typename Channel>
+    void BM_Compress(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        for (auto _ : state) {benchmark::DoNotOptimize(compress_image(image));}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    // The third argument is the CppmIndexEncoding
+    template <typename Channel>
+    void BM_WriteCppm(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const CompressedImage compressed = compress_image(image);
+        const auto encoding = static_cast<CppmIndexEncoding>(state.range(2));
+        const std::string path = bench_file("imtool_bench_write.cppm");
+        for (auto _ : state) {write_cppm(path, compressed, encoding);}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    template <typename Channel>
+    void BM_ReadCppm(benchmark::State& state) {
+        const BasicImage<Channel>& image = bench_image<Channel>(state);
+        const std::string path = bench_file("imtool_bench_read.cppm");
+        write_cppm(path, compress_image(image), static_cast<CppmIndexEncoding>(state.range(2)));
+        for (auto _ : state) {benchmark::DoNotOptimize(read_cppm(path));}
+        set_megapixel_rate(state, image.width, image.height);
+    }
+
+    void image_sizes(benchmark::internal::Benchmark* bench) {
+        image_arguments(bench);
+    }
+
+    void cppm_encodings(benchmark::internal::Benchmark* bench) {
+        image_arguments(bench, "encoding", {static_cast<int64_t>(CppmIndexEncoding::bytes), static_cast<int64_t>(CppmIndexEncoding::bits),
+                                            static_cast<int64_t>(CppmIndexEncoding::runs)});
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_WritePpm, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_WritePpm, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_ReadPpm, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_ReadPpm, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_ReadPpmNative, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_ReadPpmNative, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_Compress, uint8_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_Compress, uint16_t)->Apply(image_sizes);
+BENCHMARK_TEMPLATE(BM_WriteCppm, uint8_t)->Apply(cppm_encodings);
+BENCHMARK_TEMPLATE(BM_WriteCppm, uint16_t)->Apply(cppm_encodings);
+BENCHMARK_TEMPLATE(BM_ReadCppm, uint8_t)->Apply(cppm_encodings);
+BENCHMARK_TEMPLATE(BM_ReadCppm, uint16_t)->Apply(cppm_encodings);
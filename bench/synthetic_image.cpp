@@ -0,0 +1,71 @@
+#include "synthetic_image.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+constexpr static uint32_t SYNTHETIC_SEED = 20240;
+constexpr static size_t PALETTE_COLORS = 256;
+
+namespace {
+    template <typename Channel>
+    BasicPixel<Channel> random_pixel(std::uniform_int_distribution<int>& sample, std::mt19937& generator) {
+        return {.r = static_cast<Channel>(sample(generator)), .g = static_cast<Channel>(sample(generator)),
+                .b = static_cast<Channel>(sample(generator))};
+    }
+
+    template <typename Channel>
+    void fill_noise(BasicImage<Channel>& image, std::mt19937& generator) {
+        std::uniform_int_distribution<int> sample(0, image.max_color_value);
+        for (auto& pixel : image.pixels) {pixel = random_pixel<Channel>(sample, generator);}
+    }
+
+    template <typename Channel>
+    void fill_palette(BasicImage<Channel>& image, std::mt19937& generator) {
+        std::uniform_int_distribution<int> sample(0, image.max_color_value);
+        std::vector<BasicPixel<Channel>> palette(PALETTE_COLORS);
+        for (auto& color : palette) {color = random_pixel<Channel>(sample, generator);}
+        std::uniform_int_distribution<size_t> entry(0, PALETTE_COLORS - 1);
+        for (auto& pixel : image.pixels) {pixel = palette[entry(generator)];}
+    }
+
+    // Each channel ramps along a different direction, with a little noise so
+    // neighboring pixels are close but rarely equal
+    template <typename Channel>
+    void fill_gradient(BasicImage<Channel>& image, std::mt19937& generator) {
+        std::uniform_int_distribution<int> jitter(0, 2);
+        const auto ramp = [&image, &jitter, &generator](size_t position, size_t extent) {
+            const auto value = static_cast<int>(position * static_cast<size_t>(image.max_color_value) / extent) + jitter(generator);
+            return static_cast<Channel>(std::min(value, image.max_color_value));
+        };
+        const auto width = static_cast<size_t>(image.width);
+        const auto height = static_cast<size_t>(image.height);
+        for (size_t y = 0; y < height; ++y) {
+            for (size_t x = 0; x < width; ++x) {
+                image.pixels[(y * width) + x] = {.r = ramp(x, width), .g = ramp(y, height), .b = ramp(x + y, width + height)};
+            }
+        }
+    }
+}
+
+std::string_view distribution_name(const ColorDistribution distribution) {
+    constexpr static std::array<std::string_view, 3> NAMES = {"noise", "palette", "gradient"};
+    return NAMES.at(static_cast<size_t>(distribution));
+}
+
+template <typename Channel>
+BasicImage<Channel> synthetic_image(const int width, const int height, const int max_color_value, const ColorDistribution distribution) {
+    BasicImage<Channel> image{.width = width, .height = height, .max_color_value = max_color_value,
+                              .pixels = std::vector<BasicPixel<Channel>>(static_cast<size_t>(width) * static_cast<size_t>(height))};
+    std::mt19937 generator(SYNTHETIC_SEED);
+    switch (distribution) {
+        case ColorDistribution::noise: fill_noise(image, generator); break;
+        case ColorDistribution::palette: fill_palette(image, generator); break;
+        case ColorDistribution::gradient: fill_gradient(image, generator); break;
+    }
+    return image;
+}
+
+template BasicImage<uint8_t> synthetic_image(int width, int height, int max_color_value, ColorDistribution distribution);
+template BasicImage<uint16_t> synthetic_image(int width, int height, int max_color_value, ColorDistribution distribution);
@@ -0,0 +1,23 @@
+#ifndef SYNTHETIC_IMAGE_HPP
+#define SYNTHETIC_IMAGE_HPP
+
+#include "common/image_types.hpp"
+#include <cstdint>
+#include <string_view>
+
+// How the colors of a synthetic image are spread, which is what decides the
+// cost of compress and cutfreq and the size of a CPPM file
+enum class ColorDistribution : uint8_t {
+    noise,     // Every sample independent: almost every pixel is its own color
+    palette,   // A few hundred colors scattered over the image
+    gradient,  // Smooth ramps like a photo: many colors, long runs of similar ones
+};
+
+std::string_view distribution_name(ColorDistribution distribution);
+
+// Deterministic image of the given size with samples in [0, max_color_value].
+// Instantiated for 8-bit and 16-bit channels.
+template <typename Channel>
+BasicImage<Channel> synthetic_image(int width, int height, int max_color_value, ColorDistribution distribution);
+
+#endif // SYNTHETIC_IMAGE_HPP
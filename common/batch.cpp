@@ -0,0 +1,66 @@
+#include "batch.hpp"
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <helpers/helpers.hpp>
+#include <helpers/thread_pool.hpp>
+
+constexpr static char COMMENT_MARKER = '#';
+
+namespace {
+    // "line: input -> output" for the status line; a line too short to parse
+    // shows what it has
+    std::string describe(const BatchJob& job) {
+        std::string text = std::to_string(job.line) + ":";
+        if (!job.words.empty()) {text += " " + job.words[0];}
+        if (job.words.size() > 1) {text += " -> " + job.words[1];}
+        return text;
+    }
+
+    // Runs one job and returns its outcome for the status line
+    std::string run_one(const BatchJob& job, const std::function<void(const ProgArgs&)>& run_job, bool& failed) {
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            run_job(ProgArgs::parse_job(job.words));
+        } catch (const std::exception& error) {
+            failed = true;
+            return std::string("FAILED ") + error.what();
+        }
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        return "OK (" + std::to_string(elapsed.count()) + " ms)";
+    }
+}
+
+std::vector<BatchJob> read_manifest(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {throw std::runtime_error("Error: Could not open batch manifest " + path);}
+    std::vector<BatchJob> jobs;
+    std::string text;
+    for (size_t line = 1; std::getline(file, text); ++line) {
+        std::istringstream stream(text);
+        std::vector<std::string> words;
+        for (std::string word; stream >> word;) {words.push_back(word);}
+        if (words.empty() || words[0].front() == COMMENT_MARKER) {continue;}
+        jobs.push_back({.line = line, .words = std::move(words)});
+    }
+    return jobs;
+}
+
+size_t run_batch(const std::vector<BatchJob>& jobs, const unsigned workers,
+                 const std::function<void(const ProgArgs&)>& run_job, std::ostream& status) {
+    ThreadPool pool(workers == 0 ? threadCount() : workers);
+    std::mutex status_mutex;
+    size_t failures = 0;
+    pool.run(jobs.size(), [&](const size_t index) {
+        bool failed = false;
+        const std::string outcome = run_one(jobs[index], run_job, failed);
+        const std::scoped_lock lock(status_mutex);
+        if (failed) {++failures;}
+        status << describe(jobs[index]) << ": " << outcome << std::endl;
+    });
+    return failures;
+}
@@ -0,0 +1,31 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "progargs.hpp"
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// One manifest line, "input output op [params] [+ op [params]]...", split
+// on whitespace. line is the 1-based line number used in status lines.
+struct BatchJob {
+    size_t line;
+    std::vector<std::string> words;
+};
+
+// Reads every job from a manifest; blank lines and lines starting with '#'
+// are skipped
+std::vector<BatchJob> read_manifest(const std::string& path);
+
+// Runs every job on a pool of workers threads (0 uses threadCount()). Each
+// worker takes a whole image through decode, its stages and encode, so the
+// workers overlap those phases across images; parallel helpers called from a
+// job run on that job's worker. A job that fails to parse or throws does not
+// stop the others. One status line per job is written to status as it
+// finishes. Returns the number of failed jobs.
+size_t run_batch(const std::vector<BatchJob>& jobs, unsigned workers,
+                 const std::function<void(const ProgArgs&)>& run_job, std::ostream& status);
+
+#endif // BATCH_HPP
@@ -1,168 +1,608 @@
 #include "binaryio.hpp"
+#include "index_runs.hpp"
+#include "mapped_file.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <span>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
 #include <vector>
+#include <helpers/helpers.hpp>
+#include <helpers/stats.hpp>
 
 constexpr static int MaxByteValue = 255;
 constexpr static int LE_MinMaxByteValue = 256;
 constexpr static int LE_MaxByteValue = 65536;
 constexpr static int RGB_CHANNELS = 3;
 constexpr static int RGB_CHANNELS_16BIT = 6;
+constexpr static size_t WRITE_BLOCK_SAMPLES = size_t{1} << 20U;
+constexpr static size_t BYTE_BITS = 8;
+constexpr static unsigned MAX_INDEX_BITS = 32;
+constexpr static size_t RUN_BLOCK_ROWS = 64;
+// Magic number of each CppmIndexEncoding, in enumerator order
+constexpr static std::array<std::string_view, 3> CPPM_MAGIC = {"C6", "C7", "C8"};
 
-Image read_ppm(const std::string& file_path) {
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file) {throw std::runtime_error("Error: Could not open file " + file_path);}
-    std::string magic_number;
-    file >> magic_number;
-    if (magic_number != "P6") {throw std::runtime_error("Error: Invalid PPM format (not P6)");}
-    Image image{};
-    file >> image.width >> image.height >> image.max_color_value;
-    if (image.width <= 0 || image.height <= 0 || image.max_color_value <= 0) {throw std::runtime_error("Error: Invalid width, height, or max color value in PPM header");}
-    file.ignore();
-    const size_t total_pixels = static_cast<size_t>(image.width) * static_cast<size_t>(image.height);
-    image.pixels.resize(total_pixels);
-    if (image.max_color_value < MaxByteValue) {
-        for (auto& pixel : image.pixels) {
-            std::array<uint8_t, RGB_CHANNELS> rgb{};
-            file.read(reinterpret_cast<char*>(rgb.data()), RGB_CHANNELS);
-            if (file.gcount() != RGB_CHANNELS) {throw std::runtime_error("Error reading pixel data for 8-bit color with scaling");}
-            pixel = {.r=static_cast<uint8_t>(rgb[0] * MaxByteValue / image.max_color_value),.g=static_cast<uint8_t>(rgb[1] * MaxByteValue / image.max_color_value),.b=static_cast<uint8_t>(rgb[2] * MaxByteValue / image.max_color_value)};
+namespace {
+    // Whitespace-separated header fields, parsed the way operator>> would
+    class HeaderCursor {
+      public:
+        explicit HeaderCursor(std::span<const uint8_t> bytes) : bytes(bytes) {}
+
+        std::string_view next_token() {
+            skip_whitespace();
+            const size_t start = position;
+            while (position < bytes.size() && std::isspace(bytes[position]) == 0) {++position;}
+            return {reinterpret_cast<const char*>(bytes.subspan(start).data()), position - start};
         }
-    } else if (image.max_color_value == MaxByteValue) {
-        for (auto& pixel : image.pixels) {
-            std::array<uint8_t, RGB_CHANNELS> rgb{};
-            file.read(reinterpret_cast<char*>(rgb.data()), RGB_CHANNELS);
-            if (file.gcount() != RGB_CHANNELS) {throw std::runtime_error("Error reading pixel data for 8-bit color without scaling");}
-            pixel = {.r=rgb[0], .g=rgb[1], .b=rgb[2]};
+
+        // Leaves the value at zero when the field is missing or not a number
+        template <typename T>
+        T next_number() {
+            skip_whitespace();
+            T value{};
+            const auto* const first = reinterpret_cast<const char*>(bytes.subspan(position).data());
+            const auto [last, error] = std::from_chars(first, first + (bytes.size() - position), value);
+            if (error != std::errc{}) {return T{};}
+            position += static_cast<size_t>(last - first);
+            return value;
         }
-    } else {
-        for (auto& pixel : image.pixels) {
-            std::array<uint8_t, RGB_CHANNELS_16BIT> rgb_bytes{};
-            file.read(reinterpret_cast<char*>(rgb_bytes.data()), RGB_CHANNELS_16BIT);
-            if (file.gcount() != RGB_CHANNELS_16BIT) {throw std::runtime_error("Error reading pixel data for 16-bit color");}
-            const auto red = static_cast<uint16_t>((static_cast<uint16_t>(rgb_bytes[0]) << 8) | rgb_bytes[1]);
-            const auto green = static_cast<uint16_t>((static_cast<uint16_t>(rgb_bytes[2]) << 8) | rgb_bytes[3]);
-            const auto blue = static_cast<uint16_t>((static_cast<uint16_t>(rgb_bytes[4]) << 8) | rgb_bytes[5]);
 
-            pixel = {.r=static_cast<uint8_t>(red * MaxByteValue / image.max_color_value),.g=static_cast<uint8_t>(green * MaxByteValue / image.max_color_value),.b=static_cast<uint8_t>(blue * MaxByteValue / image.max_color_value)};
+        // Skips the single whitespace byte that separates the header from the raster
+        void skip_one() {if (position < bytes.size()) {++position;}}
+
+        [[nodiscard]] size_t offset() const { return position; }
+
+      private:
+        void skip_whitespace() {
+            while (position < bytes.size() && std::isspace(bytes[position]) != 0) {++position;}
+        }
+
+        std::span<const uint8_t> bytes;
+        size_t position = 0;
+    };
+
+    // Maps every possible sample to its 8-bit value using the scaling formula of the reader
+    std::vector<uint32_t> build_scale_table(size_t sample_count, int max_color_value) {
+        std::vector<uint32_t> table(sample_count);
+        for (size_t sample = 0; sample < sample_count; ++sample) {
+            table[sample] = static_cast<uint32_t>(static_cast<int>(sample) * MaxByteValue / max_color_value);
+        }
+        return table;
+    }
+
+    void decode_8bit(std::span<const uint8_t> raster, std::span<Pixel> pixels) {
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            const size_t base = i * RGB_CHANNELS;
+            pixels[i] = {.r=raster[base], .g=raster[base + 1], .b=raster[base + 2]};
+        }
+    }
+
+    void decode_scaled_8bit(std::span<const uint8_t> raster, std::span<Pixel> pixels, int max_color_value) {
+        const std::span<uint16_t> samples = pixel_samples(pixels);
+        lookup_samples<uint8_t, uint16_t>(build_scale_table(LE_MinMaxByteValue, max_color_value), raster.first(samples.size()), samples);
+    }
+
+    uint16_t big_endian_sample(std::span<const uint8_t> raster, size_t offset) {
+        return static_cast<uint16_t>((static_cast<unsigned>(raster[offset]) << 8U) | raster[offset + 1]);
+    }
+
+    void decode_16bit(std::span<const uint8_t> raster, std::span<Pixel> pixels, int max_color_value) {
+        const std::span<uint16_t> samples = pixel_samples(pixels);
+        lookup_big_endian_samples<uint16_t>(build_scale_table(LE_MaxByteValue, max_color_value), raster.first(2 * samples.size()), samples);
+    }
+
+    // Keeps 16-bit samples at their stored precision
+    void decode_raw_16bit(std::span<const uint8_t> raster, std::span<Pixel> pixels) {
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            const size_t base = i * RGB_CHANNELS_16BIT;
+            pixels[i] = {.r=big_endian_sample(raster, base), .g=big_endian_sample(raster, base + 2),
+                         .b=big_endian_sample(raster, base + 4)};
+        }
+    }
+
+    // Parses "P6 width height maxval" and leaves the cursor on the first raster byte
+    Image parse_ppm_header(HeaderCursor& header) {
+        if (header.next_token() != "P6") {throw std::runtime_error("Error: Invalid PPM format (not P6)");}
+        Image image{};
+        image.width = header.next_number<int>();
+        image.height = header.next_number<int>();
+        image.max_color_value = header.next_number<int>();
+        if (image.width <= 0 || image.height <= 0 || image.max_color_value <= 0) {throw std::runtime_error("Error: Invalid width, height, or max color value in PPM header");}
+        header.skip_one();
+        return image;
+    }
+
+    [[noreturn]] void throw_truncated_raster(int max_color_value) {
+        if (max_color_value < MaxByteValue) {throw std::runtime_error("Error reading pixel data for 8-bit color with scaling");}
+        if (max_color_value == MaxByteValue) {throw std::runtime_error("Error reading pixel data for 8-bit color without scaling");}
+        throw std::runtime_error("Error reading pixel data for 16-bit color");
+    }
+
+    size_t bytes_per_pixel(int max_color_value) {
+        return max_color_value > MaxByteValue ? RGB_CHANNELS_16BIT : RGB_CHANNELS;
+    }
+
+    // Byte width of a stored palette index for a given color table size
+    size_t index_width(size_t color_table_size) {
+        if (color_table_size <= LE_MinMaxByteValue) {return 1;}
+        if (color_table_size <= LE_MaxByteValue) {return 2;}
+        return 4;
+    }
+
+    // Smallest bit width that can address every color table entry (at least 1)
+    unsigned packed_index_bits(size_t color_table_size) {
+        return std::max(1U, static_cast<unsigned>(std::bit_width(color_table_size - 1)));
+    }
+
+    size_t packed_index_bytes(size_t index_count, unsigned bits) {
+        return ((index_count * bits) + BYTE_BITS - 1) / BYTE_BITS;
+    }
+
+    // Color table size and stored index width of a CPPM file
+    struct CppmLayout {
+        size_t color_count;
+        unsigned index_bits;  // 0 for run-length coded files
+        size_t block_rows;    // Rows per run-length coded block, 0 otherwise
+    };
+}
+
+namespace {
+    std::string ppm_header(int width, int height, int max_color_value) {
+        return "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n" + std::to_string(max_color_value) + "\n";
+    }
+
+    // Encodes pixels block by block and appends them to the stream
+    void write_raster(std::ostream& out_file, std::span<const Pixel> pixels, int max_color_value) {
+        bool const use_1_byte_per_channel = (max_color_value <= MaxByteValue);
+        const size_t bytes_per_sample = use_1_byte_per_channel ? 1 : 2;
+        const std::span<const uint16_t> samples = pixel_samples(pixels);
+        std::vector<uint8_t> buffer(std::min(samples.size(), WRITE_BLOCK_SAMPLES) * bytes_per_sample);
+        for (size_t first = 0; first < samples.size(); first += WRITE_BLOCK_SAMPLES) {
+            const std::span<const uint16_t> block = samples.subspan(first, std::min(WRITE_BLOCK_SAMPLES, samples.size() - first));
+            if (use_1_byte_per_channel) {
+                narrow_u16_to_u8(block, buffer);
+            } else {
+                store_u16_big_endian(block, buffer);
+            }
+            out_file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(block.size() * bytes_per_sample));
+        }
+    }
+
+    // 8-bit samples are already in file order and only need widening for a 16-bit header
+    void write_raster(std::ostream& out_file, std::span<const BasicPixel<uint8_t>> pixels, int max_color_value) {
+        const std::span<const uint8_t> samples = pixel_samples(pixels);
+        if (max_color_value <= MaxByteValue) {
+            out_file.write(reinterpret_cast<const char*>(samples.data()), static_cast<std::streamsize>(samples.size()));
+            return;
+        }
+        std::vector<uint8_t> buffer(std::min(samples.size(), WRITE_BLOCK_SAMPLES) * 2, 0);
+        for (size_t first = 0; first < samples.size(); first += WRITE_BLOCK_SAMPLES) {
+            const std::span<const uint8_t> block = samples.subspan(first, std::min(WRITE_BLOCK_SAMPLES, samples.size() - first));
+            for (size_t i = 0; i < block.size(); ++i) {buffer[(2 * i) + 1] = block[i];}
+            out_file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(block.size() * 2));
         }
     }
-    if (file.fail()) {throw std::runtime_error("Error: Unexpected end of file or read error");}
+
+    template <typename Channel>
+    BasicImage<Channel> decode_native(const Image& header, std::span<const uint8_t> raster) {
+        BasicImage<Channel> image{.width=header.width, .height=header.height, .max_color_value=header.max_color_value, .pixels={}};
+        image.pixels.resize(static_cast<size_t>(header.width) * static_cast<size_t>(header.height));
+        const std::span<Channel> samples = pixel_samples(std::span(image.pixels));
+        if constexpr (sizeof(Channel) == 1) {
+            std::ranges::copy(raster.first(samples.size()), samples.begin());
+        } else {
+            load_u16_big_endian(raster.first(samples.size() * 2), samples);
+        }
+        return image;
+    }
+}
+
+MappedPpm map_ppm(const std::string& file_path) {
+    const ScopedTimer timer("read.header");
+    MappedPpm mapped{.file=MappedFile(file_path), .header={}, .raster={}};
+    if (!mapped.file.is_open()) {throw std::runtime_error("Error: Could not open file " + file_path);}
+    addStatCounter("read.bytes", mapped.file.bytes().size());
+    HeaderCursor cursor(mapped.file.bytes());
+    mapped.header = parse_ppm_header(cursor);
+    const size_t total_pixels = static_cast<size_t>(mapped.header.width) * static_cast<size_t>(mapped.header.height);
+    const std::span<const uint8_t> raster = mapped.file.bytes().subspan(cursor.offset());
+    const size_t pixel_bytes = bytes_per_pixel(mapped.header.max_color_value);
+    if (raster.size() / pixel_bytes < total_pixels) {throw_truncated_raster(mapped.header.max_color_value);}
+    mapped.raster = raster.first(total_pixels * pixel_bytes);
+    return mapped;
+}
+
+AnyImage read_ppm_native(const std::string& file_path) {
+    const MappedPpm file = map_ppm(file_path);
+    const ScopedTimer timer("read.decode");
+    addStatCounter("read.pixels", static_cast<uint64_t>(file.header.width) * static_cast<uint64_t>(file.header.height));
+    if (file.header.max_color_value <= MaxByteValue) {return decode_native<uint8_t>(file.header, file.raster);}
+    return decode_native<uint16_t>(file.header, file.raster);
+}
+
+Image read_ppm(const std::string& file_path) {
+    const MappedPpm file = map_ppm(file_path);
+    const ScopedTimer timer("read.decode");
+    addStatCounter("read.pixels", static_cast<uint64_t>(file.header.width) * static_cast<uint64_t>(file.header.height));
+    Image image = file.header;
+    image.pixels.resize(static_cast<size_t>(image.width) * static_cast<size_t>(image.height));
+    if (image.max_color_value < MaxByteValue) {
+        decode_scaled_8bit(file.raster, image.pixels, image.max_color_value);
+    } else if (image.max_color_value == MaxByteValue) {
+        decode_8bit(file.raster, image.pixels);
+    } else {
+        decode_16bit(file.raster, image.pixels, image.max_color_value);
+    }
     return image;
 }
 
-void write_ppm(const std::string& file_path, const Image& image) {
+template <typename Channel>
+void write_ppm(const std::string& file_path, const BasicImage<Channel>& image) {
+    const ScopedTimer timer("write.ppm");
     std::ofstream out_file(file_path, std::ios::binary);
     if (!out_file) {
         throw std::runtime_error("Could not open file for writing: " + file_path);
     }
-    out_file << "P6\n" << image.width << " " << image.height << "\n" << image.max_color_value << "\n";
+    const std::string header = ppm_header(image.width, image.height, image.max_color_value);
+    out_file.write(header.data(), static_cast<std::streamsize>(header.size()));
 
-    bool const use_1_byte_per_channel = (image.max_color_value <= MaxByteValue);
-    for (const auto& pixel : image.pixels) {
-      if (use_1_byte_per_channel) {
-        out_file.put(static_cast<char>(pixel.r & MaxByteValue))
-                .put(static_cast<char>(pixel.g & MaxByteValue))
-                .put(static_cast<char>(pixel.b & MaxByteValue));
-      } else {
-            const uint16_t red = pixel.r;
-            const uint16_t green = pixel.g;
-            const uint16_t blue = pixel.b;
-            const std::array<uint8_t, RGB_CHANNELS_16BIT> rgb_bytes = {
-                static_cast<uint8_t>(red >> 8), static_cast<uint8_t>(red & 0xFF),
-                static_cast<uint8_t>(green >> 8), static_cast<uint8_t>(green & 0xFF),
-                static_cast<uint8_t>(blue >> 8), static_cast<uint8_t>(blue & 0xFF)
-            };
-            out_file.write(reinterpret_cast<const char*>(rgb_bytes.data()), RGB_CHANNELS_16BIT);
-        }
-    }
+    write_raster(out_file, std::span(image.pixels), image.max_color_value);
 
     if (!out_file) {
         throw std::runtime_error("Error writing to file: " + file_path);
     }
+    addStatCounter("write.bytes", static_cast<uint64_t>(out_file.tellp()));
 }
 
-void write_cppm(const std::string& file_path, const CompressedImage& image) {
-    std::ofstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Error: Could not open file for writing: " + file_path);
+template void write_ppm(const std::string& file_path, const BasicImage<uint8_t>& image);
+template void write_ppm(const std::string& file_path, const BasicImage<uint16_t>& image);
+
+constexpr static size_t HEADER_PROBE_BYTES = 4096;
+
+PpmStripReader::PpmStripReader(const std::string& file_path) : file(file_path, std::ios::binary) {
+    if (!file) {throw std::runtime_error("Error: Could not open file " + file_path);}
+    std::vector<uint8_t> probe(HEADER_PROBE_BYTES);
+    file.read(reinterpret_cast<char*>(probe.data()), static_cast<std::streamsize>(probe.size()));
+    probe.resize(static_cast<size_t>(file.gcount()));
+    HeaderCursor cursor(probe);
+    header = parse_ppm_header(cursor);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(cursor.offset()));
+}
+
+size_t PpmStripReader::read_rows(std::span<Pixel> rows) {
+    const auto row_width = static_cast<size_t>(header.width);
+    const size_t row_count = std::min(rows.size() / row_width, static_cast<size_t>(rows_remaining()));
+    const std::span<Pixel> strip = rows.first(row_count * row_width);
+    buffer.resize(strip.size() * bytes_per_pixel(header.max_color_value));
+    file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if (static_cast<size_t>(file.gcount()) != buffer.size()) {throw_truncated_raster(header.max_color_value);}
+    if (header.max_color_value > MaxByteValue) {
+        decode_raw_16bit(buffer, strip);
+    } else {
+        decode_8bit(buffer, strip);
+    }
+    next_row += static_cast<int>(row_count);
+    return row_count;
+}
+
+PpmStripWriter::PpmStripWriter(const std::string& file_path, int width, int height, int max_color_value)
+    : out_file(file_path, std::ios::binary), path(file_path), width(width), height(height),
+      max_color_value(max_color_value) {
+    if (!out_file) {throw std::runtime_error("Could not open file for writing: " + file_path);}
+    const std::string header = ppm_header(width, height, max_color_value);
+    out_file.write(header.data(), static_cast<std::streamsize>(header.size()));
+}
+
+void PpmStripWriter::write_rows(std::span<const Pixel> rows) {
+    const size_t row_count = rows.size() / static_cast<size_t>(width);
+    if (row_count > static_cast<size_t>(height - next_row)) {throw std::runtime_error("Error: Too many rows written to " + path);}
+    write_raster(out_file, rows.first(row_count * static_cast<size_t>(width)), max_color_value);
+    next_row += static_cast<int>(row_count);
+}
+
+void PpmStripWriter::finish() {
+    if (next_row != height) {throw std::runtime_error("Error: Missing rows in " + path);}
+    out_file.flush();
+    if (!out_file) {throw std::runtime_error("Error writing to file: " + path);}
+}
+
+namespace {
+    // 8-bit colors keep the 4-byte entries of the original format; 16-bit colors need 8 bytes
+    void write_color_table(std::ostream& file, const CompressedImage& image) {
+        if (image.max_color > MaxByteValue) {
+            file.write(reinterpret_cast<const char*>(image.color_table.data()),
+                       static_cast<std::streamsize>(image.color_table.size() * sizeof(uint64_t)));
+            return;
+        }
+        std::vector<uint32_t> narrow(image.color_table.size());
+        std::ranges::transform(image.color_table, narrow.begin(), [](uint64_t color) { return static_cast<uint32_t>(color); });
+        file.write(reinterpret_cast<const char*>(narrow.data()), static_cast<std::streamsize>(narrow.size() * sizeof(uint32_t)));
     }
-    file << "C6\n" << image.width << " " << image.height << "\n"
-         << image.max_color << "\n" << image.color_table.size() << "\n";
+}
 
-    for (const auto& color : image.color_table) {
-        file.write(reinterpret_cast<const char*>(&color), sizeof(uint32_t));
+namespace {
+    void write_byte_indices(std::ostream& file, std::span<const uint32_t> indices, const size_t index_byte_length) {
+        if (index_byte_length == sizeof(uint32_t)) {
+            file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(uint32_t)));
+            return;
+        }
+        std::vector<uint8_t> buffer(std::min(indices.size(), WRITE_BLOCK_SAMPLES) * index_byte_length);
+        for (size_t first = 0; first < indices.size(); first += WRITE_BLOCK_SAMPLES) {
+            const std::span<const uint32_t> block = indices.subspan(first, std::min(WRITE_BLOCK_SAMPLES, indices.size() - first));
+            if (index_byte_length == 1) {
+                pack_indices_u8(block, buffer);
+            } else {
+                pack_indices_u16(block, buffer);
+            }
+            file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(block.size() * index_byte_length));
+        }
     }
 
-    size_t index_byte_length = 0;
-    if (image.color_table.size() <= LE_MinMaxByteValue) {
-      index_byte_length = 1;
-    } else if (image.color_table.size() <= LE_MaxByteValue) {
-      index_byte_length = 2;
-    } else {
-      index_byte_length = 4;
+    // Blocks hold a multiple of 8 indices, so every block starts on a byte boundary
+    void write_packed_indices(std::ostream& file, std::span<const uint32_t> indices, const unsigned bits) {
+        std::vector<uint8_t> buffer(packed_index_bytes(std::min(indices.size(), WRITE_BLOCK_SAMPLES), bits));
+        for (size_t first = 0; first < indices.size(); first += WRITE_BLOCK_SAMPLES) {
+            const std::span<const uint32_t> block = indices.subspan(first, std::min(WRITE_BLOCK_SAMPLES, indices.size() - first));
+            const size_t block_bytes = packed_index_bytes(block.size(), bits);
+            pack_indices_bits(block, bits, std::span(buffer).first(block_bytes));
+            file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(block_bytes));
+        }
     }
+}
 
-    for (const auto& index : image.pixel_indices) {
-        if (index_byte_length == 1) {
-            auto idx = static_cast<uint8_t>(index);
-            file.write(reinterpret_cast<const char*>(&idx), 1);
-        } else if (index_byte_length == 2) {
-            auto idx = static_cast<uint16_t>(index);
-            file.write(reinterpret_cast<const char*>(&idx), 2);
-        } else {
-            auto idx = static_cast<uint32_t>(index);
-            file.write(reinterpret_cast<const char*>(&idx), 4);
+namespace {
+    // Encodes blocks of RUN_BLOCK_ROWS rows in parallel, then writes the block
+    // offset table followed by the blocks
+    void write_run_blocks(std::ostream& file, const CompressedImage& image) {
+        const std::span<const uint32_t> indices = image.pixel_indices;
+        const size_t block_pixels = RUN_BLOCK_ROWS * static_cast<size_t>(image.width);
+        const size_t block_count = (indices.size() + block_pixels - 1) / block_pixels;
+        std::vector<std::vector<uint8_t>> blocks(block_count);
+        parallelForBlocks(block_count, 1, [&](size_t first, size_t last) {
+            for (size_t block = first; block < last; ++block) {
+                const size_t first_pixel = block * block_pixels;
+                append_index_runs(indices.subspan(first_pixel, std::min(block_pixels, indices.size() - first_pixel)), blocks[block]);
+            }
+        });
+        std::vector<uint64_t> offsets(block_count + 1, 0);
+        for (size_t block = 0; block < block_count; ++block) {offsets[block + 1] = offsets[block] + blocks[block].size();}
+        file.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+        for (const std::vector<uint8_t>& block : blocks) {
+            file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size()));
         }
     }
 
+    // Format-specific header line after the color table size, if any
+    std::string cppm_layout_line(const CompressedImage& image, const CppmIndexEncoding encoding) {
+        if (encoding == CppmIndexEncoding::bits) {return std::to_string(packed_index_bits(image.color_table.size())) + "\n";}
+        if (encoding == CppmIndexEncoding::runs) {return std::to_string(RUN_BLOCK_ROWS) + "\n";}
+        return "";
+    }
+}
+
+std::optional<CppmIndexEncoding> cppm_encoding_from_name(const std::string_view name) {
+    if (name == "bytes") {return CppmIndexEncoding::bytes;}
+    if (name == "bits") {return CppmIndexEncoding::bits;}
+    if (name == "runs") {return CppmIndexEncoding::runs;}
+    return std::nullopt;
+}
+
+void write_cppm(const std::string& file_path, const CompressedImage& image, const CppmIndexEncoding encoding) {
+    const ScopedTimer timer("write.cppm");
+    std::ofstream file(file_path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Error: Could not open file for writing: " + file_path);
+    }
+    const std::string header = std::string(CPPM_MAGIC.at(static_cast<size_t>(encoding))) + "\n" + std::to_string(image.width) + " " +
+                               std::to_string(image.height) + "\n" + std::to_string(image.max_color) + "\n" +
+                               std::to_string(image.color_table.size()) + "\n" + cppm_layout_line(image, encoding);
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+    write_color_table(file, image);
+    if (encoding == CppmIndexEncoding::bits) {
+        write_packed_indices(file, image.pixel_indices, packed_index_bits(image.color_table.size()));
+    } else if (encoding == CppmIndexEncoding::runs) {
+        write_run_blocks(file, image);
+    } else {
+        write_byte_indices(file, image.pixel_indices, index_width(image.color_table.size()));
+    }
+
     if (!file) {
         throw std::runtime_error("Error: Failed to write to file: " + file_path);
     }
+    addStatCounter("write.bytes", static_cast<uint64_t>(file.tellp()));
     file.close();
 }
 
-CompressedImage read_cppm(const std::string& file_path) {
-    std::ifstream file(file_path, std::ios::binary);
+namespace {
+    // Reads the field after the table size: the bit width of "C7" files or the
+    // block height of "C8" files
+    void parse_cppm_layout(HeaderCursor& header, const std::string_view magic, CppmLayout& layout) {
+        if (magic == CPPM_MAGIC[static_cast<size_t>(CppmIndexEncoding::runs)]) {
+            layout.block_rows = header.next_number<size_t>();
+            if (layout.block_rows == 0) {throw std::runtime_error("Error: Invalid block height in CPPM header");}
+            return;
+        }
+        const bool packed = magic == CPPM_MAGIC[static_cast<size_t>(CppmIndexEncoding::bits)];
+        layout.index_bits = packed ? header.next_number<unsigned>() : static_cast<unsigned>(index_width(layout.color_count) * BYTE_BITS);
+        if (layout.index_bits < packed_index_bits(layout.color_count) || layout.index_bits > MAX_INDEX_BITS) {
+            throw std::runtime_error("Error: Invalid index width in CPPM header");
+        }
+    }
+
+    // Parses "C6 width height max_color table_size", followed by the index bits
+    // for "C7" or the block rows for "C8", and leaves the cursor on the color table
+    CompressedImage parse_cppm_header(HeaderCursor& header, CppmLayout& layout) {
+        const std::string_view magic = header.next_token();
+        if (std::ranges::find(CPPM_MAGIC, magic) == CPPM_MAGIC.end()) {throw std::runtime_error("Error: Invalid CPPM format");}
+        CompressedImage image{};
+        image.width = header.next_number<int>();
+        image.height = header.next_number<int>();
+        image.max_color = header.next_number<int>();
+        layout.color_count = header.next_number<size_t>();
+        if (image.width <= 0 || image.height <= 0 || image.max_color <= 0 || layout.color_count == 0) {
+            throw std::runtime_error("Error: Invalid width, height, max color value or color table size in CPPM header");
+        }
+        parse_cppm_layout(header, magic, layout);
+        header.skip_one();
+        return image;
+    }
+}
+
+CompressedImageView::CompressedImageView(const std::string& file_path) : file(file_path) {
+    const ScopedTimer timer("read.header");
     if (!file.is_open()) {throw std::runtime_error("Error: Could not open file for reading: " + file_path);}
-    CompressedImage image{};
-    std::string magic;
-    file >> magic;
-    if (magic != "C6") {throw std::runtime_error("Error: Invalid CPPM format");}
-    file >> image.width >> image.height >> image.max_color;
-    size_t color_table_size = 0;
-    file >> color_table_size;
-    file.ignore();
-    image.color_table.resize(color_table_size);
-    for (auto& color : image.color_table) {file.read(reinterpret_cast<char*>(&color), sizeof(uint32_t));}
-    size_t index_byte_length = 0;
-    if (color_table_size <= LE_MinMaxByteValue) {
-      index_byte_length = 1;
-    } else if (color_table_size <= LE_MaxByteValue) {
-      index_byte_length = 2;
+    addStatCounter("read.bytes", file.bytes().size());
+    HeaderCursor cursor(file.bytes());
+    CppmLayout layout{};
+    header = parse_cppm_header(cursor, layout);
+    bits_per_index = layout.index_bits;
+    rows_per_block = layout.block_rows;
+    const size_t pixel_count = static_cast<size_t>(header.width) * static_cast<size_t>(header.height);
+    const size_t entry_bytes = color_entry_width();
+    const std::span<const uint8_t> body = file.bytes().subspan(cursor.offset());
+    // Checked by division so corrupt header sizes cannot overflow the expected length
+    if (body.size() / entry_bytes < layout.color_count) {throw std::runtime_error("Error: Truncated CPPM file: " + file_path);}
+    table = body.first(layout.color_count * entry_bytes);
+    const std::span<const uint8_t> stream = body.subspan(table.size());
+    if (rows_per_block > 0) {
+        locate_run_blocks(stream, file_path);
+        return;
+    }
+    if (stream.size() * BYTE_BITS / bits_per_index < pixel_count) {throw std::runtime_error("Error: Truncated CPPM file: " + file_path);}
+    indices = stream.first(packed_index_bytes(pixel_count, bits_per_index));
+}
+
+void CompressedImageView::locate_run_blocks(std::span<const uint8_t> stream, const std::string& file_path) {
+    const size_t block_count = (static_cast<size_t>(header.height) + rows_per_block - 1) / rows_per_block;
+    if (stream.size() / sizeof(uint64_t) <= block_count) {throw std::runtime_error("Error: Truncated CPPM file: " + file_path);}
+    block_offsets = stream.first((block_count + 1) * sizeof(uint64_t));
+    uint64_t previous = 0;
+    for (size_t block = 0; block <= block_count; ++block) {
+        const uint64_t offset = block_offset(block);
+        if (offset < previous || (block == 0 && offset != 0)) {throw std::runtime_error("Error: Invalid block offsets in CPPM file: " + file_path);}
+        previous = offset;
+    }
+    const std::span<const uint8_t> blocks = stream.subspan(block_offsets.size());
+    if (previous > blocks.size()) {throw std::runtime_error("Error: Truncated CPPM file: " + file_path);}
+    indices = blocks.first(previous);
+}
+
+uint64_t CompressedImageView::block_offset(const size_t block) const {
+    uint64_t offset = 0;
+    std::memcpy(&offset, block_offsets.subspan(block * sizeof(uint64_t)).data(), sizeof(uint64_t));
+    return offset;
+}
+
+// Decodes every block overlapping [first_pixel, first_pixel + out.size()) in
+// parallel; blocks only partly inside the range go through a scratch buffer
+void CompressedImageView::decode_run_blocks(const size_t first_pixel, std::span<uint32_t> out) const {
+    const size_t pixel_count = static_cast<size_t>(header.width) * static_cast<size_t>(header.height);
+    const size_t block_pixels = rows_per_block * static_cast<size_t>(header.width);
+    const size_t first_block = first_pixel / block_pixels;
+    const size_t block_count = ((first_pixel + out.size() + block_pixels - 1) / block_pixels) - first_block;
+    parallelForBlocks(block_count, 1, [&](size_t first, size_t last) {
+        for (size_t block = first_block + first; block < first_block + last; ++block) {
+            const size_t block_start = block * block_pixels;
+            const size_t block_size = std::min(block_pixels, pixel_count - block_start);
+            const std::span<const uint8_t> encoded = indices.subspan(block_offset(block), block_offset(block + 1) - block_offset(block));
+            const size_t begin = std::max(block_start, first_pixel);
+            const size_t end = std::min(block_start + block_size, first_pixel + out.size());
+            if (begin == block_start && end == block_start + block_size) {
+                decode_index_runs(encoded, out.subspan(begin - first_pixel, block_size));
+                continue;
+            }
+            std::vector<uint32_t> scratch(block_size);
+            decode_index_runs(encoded, scratch);
+            std::ranges::copy(std::span(scratch).subspan(begin - block_start, end - begin), out.begin() + static_cast<std::ptrdiff_t>(begin - first_pixel));
+        }
+    });
+}
+
+size_t CompressedImageView::color_entry_width() const {
+    return header.max_color > MaxByteValue ? sizeof(uint64_t) : sizeof(uint32_t);
+}
+
+uint64_t CompressedImageView::color(const size_t entry) const {
+    const std::span<const uint8_t> stored = table.subspan(entry * color_entry_width(), color_entry_width());
+    uint64_t color = 0;
+    std::memcpy(&color, stored.data(), stored.size());  // Little-endian, like the writer
+    return color;
+}
+
+uint32_t CompressedImageView::index(const size_t pixel) const {
+    uint32_t value = 0;
+    decode_indices(pixel, std::span(&value, 1));
+    return value;
+}
+
+void CompressedImageView::decode_indices(const size_t first_pixel, std::span<uint32_t> out) const {
+    if (out.empty()) {return;}
+    if (rows_per_block > 0) {
+        decode_run_blocks(first_pixel, out);
+        return;
+    }
+    if (bits_per_index % BYTE_BITS != 0) {
+        unpack_indices_bits(indices, bits_per_index, first_pixel, out);
+        return;
+    }
+    const size_t index_bytes = bits_per_index / BYTE_BITS;
+    const std::span<const uint8_t> stored = indices.subspan(first_pixel * index_bytes, out.size() * index_bytes);
+    if (index_bytes == 1) {
+        widen_indices_u8(stored, out);
+    } else if (index_bytes == 2) {
+        widen_indices_u16(stored, out);
+    } else if (index_bytes == sizeof(uint32_t)) {
+        std::memcpy(out.data(), stored.data(), stored.size());
     } else {
-      index_byte_length = 4;
-    }
-  while (file) {
-        uint32_t index = 0;
-        if (index_byte_length == 1) {
-            uint8_t idx = 0;
-            file.read(reinterpret_cast<char*>(&idx), 1);
-            index = idx;
-        } else if (index_byte_length == 2) {
-            uint16_t idx = 0;
-            file.read(reinterpret_cast<char*>(&idx), 2);
-            index = idx;
-        } else {
-            uint32_t idx = 0;
-            file.read(reinterpret_cast<char*>(&idx), 4);
-            index = idx;
+        unpack_indices_bits(indices, bits_per_index, first_pixel, out);
+    }
+}
+
+void CompressedImageView::decode_row(const int row, std::span<uint32_t> out) const {
+    if (row < 0 || row >= header.height || out.size() < static_cast<size_t>(header.width)) {
+        throw std::runtime_error("Error: Invalid row for compressed image view");
+    }
+    const auto width = static_cast<size_t>(header.width);
+    decode_indices(static_cast<size_t>(row) * width, out.first(width));
+}
+
+// Decodes a run-coded block or a single row at a time
+std::vector<size_t> CompressedImageView::palette_histogram() const {
+    std::vector<size_t> counts(color_count(), 0);
+    const size_t pixel_count = static_cast<size_t>(header.width) * static_cast<size_t>(header.height);
+    std::vector<uint32_t> chunk(std::max<size_t>(rows_per_block, 1) * static_cast<size_t>(header.width));
+    for (size_t first = 0; first < pixel_count; first += chunk.size()) {
+        const std::span<uint32_t> decoded = std::span(chunk).first(std::min(chunk.size(), pixel_count - first));
+        decode_indices(first, decoded);
+        for (const uint32_t entry : decoded) {
+            if (entry >= counts.size()) {throw std::runtime_error("Error: Color index out of range in CPPM file");}
+            ++counts[entry];
         }
-        if (file) {image.pixel_indices.push_back(index);}
     }
-    file.close();
+    return counts;
+}
+
+CompressedImage read_cppm(const std::string& file_path) {
+    const CompressedImageView view(file_path);
+    const ScopedTimer timer("read.decode");
+    CompressedImage image{.width=view.width(), .height=view.height(), .max_color=view.max_color(),
+                          .color_table=std::vector<uint64_t>(view.color_count()),
+                          .pixel_indices=std::vector<uint32_t>(static_cast<size_t>(view.width()) * static_cast<size_t>(view.height()))};
+    if (view.color_entry_width() == sizeof(uint64_t)) {
+        std::memcpy(image.color_table.data(), view.table_bytes().data(), view.table_bytes().size());
+    } else {
+        for (size_t i = 0; i < image.color_table.size(); ++i) {image.color_table[i] = view.color(i);}
+    }
+    view.decode_indices(0, image.pixel_indices);
     return image;
-}
\ No newline at end of file
+}
@@ -1,11 +1,142 @@
 #ifndef BINARY_IO_HPP
 #define BINARY_IO_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "image_types.hpp"
+#include "mapped_file.hpp"
+
+// A PPM file mapped into memory with its header parsed; raster is checked to
+// hold exactly width * height pixels in file order (big-endian when 16-bit)
+struct MappedPpm {
+    MappedFile file;
+    Image header;  // Dimensions only, pixels stay empty
+    std::span<const uint8_t> raster;
+};
+MappedPpm map_ppm(const std::string& file_path);
 
 Image read_ppm(const std::string& file_path);
-void write_ppm(const std::string& file_path, const Image& image);
-void write_cppm(const std::string& file_path, const CompressedImage& image);
+// Reads samples at their stored precision, picking 8-bit channels when
+// max_color_value <= 255 and 16-bit channels otherwise
+AnyImage read_ppm_native(const std::string& file_path);
+// Instantiated for 8-bit and 16-bit channels
+template <typename Channel>
+void write_ppm(const std::string& file_path, const BasicImage<Channel>& image);
+// Index storage of a CPPM file: "C6" files round indices up to 1, 2 or 4
+// bytes; "C7" files pack them at the smallest bit width that addresses the
+// color table and record that width after the table size in the header.
+// "C8" files run-length code independent blocks of rows (see index_runs.hpp),
+// record the block height after the table size, and put a table of
+// block count + 1 uint64 byte offsets, relative to the first block, between
+// the color table and the blocks.
+enum class CppmIndexEncoding : uint8_t {
+    bytes,
+    bits,
+    runs,
+};
+
+// Encoding selected by name on the command line ("bytes", "bits" or "runs")
+std::optional<CppmIndexEncoding> cppm_encoding_from_name(std::string_view name);
+void write_cppm(const std::string& file_path, const CompressedImage& image,
+                CppmIndexEncoding encoding = CppmIndexEncoding::bytes);
+// Accepts every CppmIndexEncoding
 CompressedImage read_cppm(const std::string& file_path);
+
+// Row-strip PPM reader for images that do not fit in memory. Only the header
+// and the strip currently being decoded are held. Unlike read_ppm, samples are
+// returned at their stored precision (0..max_color_value).
+class PpmStripReader {
+  public:
+    explicit PpmStripReader(const std::string& file_path);
+
+    [[nodiscard]] int width() const { return header.width; }
+    [[nodiscard]] int height() const { return header.height; }
+    [[nodiscard]] int max_color_value() const { return header.max_color_value; }
+    [[nodiscard]] int rows_remaining() const { return header.height - next_row; }
+
+    // Decodes as many whole rows as fit in rows and returns how many were read
+    size_t read_rows(std::span<Pixel> rows);
+
+  private:
+    std::ifstream file;
+    Image header;  // Dimensions only, pixels stay empty
+    int next_row = 0;
+    std::vector<uint8_t> buffer;
+};
+
+// Row-strip PPM writer, the counterpart of PpmStripReader
+class PpmStripWriter {
+  public:
+    PpmStripWriter(const std::string& file_path, int width, int height, int max_color_value);
+
+    // Appends whole rows; rows.size() must be a multiple of the width
+    void write_rows(std::span<const Pixel> rows);
+    // Checks that every row was written and flushes the file
+    void finish();
+
+  private:
+    std::ofstream out_file;
+    std::string path;
+    int width;
+    int height;
+    int max_color_value;
+    int next_row = 0;
+};
+
+// Read-only view of a CPPM file that maps it instead of reading it, so the
+// color table and the indices stay at their stored width (4 or 8 bytes per
+// color; 1, 2 or 4 bytes or index_bits() packed bits per index, little-endian).
+// Run-coded files decode only the blocks a request touches, in parallel.
+// Sections follow a text header of any length and may be unaligned, hence the
+// byte spans and the decoding accessors. The header and the section sizes are
+// validated on construction; index values are only checked by
+// palette_histogram.
+class CompressedImageView {
+  public:
+    explicit CompressedImageView(const std::string& file_path);
+
+    [[nodiscard]] int width() const { return header.width; }
+    [[nodiscard]] int height() const { return header.height; }
+    [[nodiscard]] int max_color() const { return header.max_color; }
+    [[nodiscard]] size_t color_count() const { return table.size() / color_entry_width(); }
+    [[nodiscard]] size_t color_entry_width() const;
+    // Stored bits per index, 0 for run-length coded files
+    [[nodiscard]] unsigned index_bits() const { return bits_per_index; }
+    // Rows per run-length coded block, 0 for files without blocks
+    [[nodiscard]] size_t block_rows() const { return rows_per_block; }
+    [[nodiscard]] std::span<const uint8_t> table_bytes() const { return table; }
+    // Stored index stream; the run-coded blocks, after the offset table, for "C8" files
+    [[nodiscard]] std::span<const uint8_t> index_bytes() const { return indices; }
+
+    // Packed color of a table entry, as in CompressedImage::color_table
+    [[nodiscard]] uint64_t color(size_t entry) const;
+    // Color table index of a pixel, in row-major order
+    [[nodiscard]] uint32_t index(size_t pixel) const;
+    // Widens out.size() indices starting at first_pixel
+    void decode_indices(size_t first_pixel, std::span<uint32_t> out) const;
+    // Widens the indices of one row into the first width() elements of out
+    void decode_row(int row, std::span<uint32_t> out) const;
+    // Number of pixels that use each color table entry
+    [[nodiscard]] std::vector<size_t> palette_histogram() const;
+
+  private:
+    void locate_run_blocks(std::span<const uint8_t> stream, const std::string& file_path);
+    [[nodiscard]] uint64_t block_offset(size_t block) const;
+    void decode_run_blocks(size_t first_pixel, std::span<uint32_t> out) const;
+
+    MappedFile file;
+    CompressedImage header;  // Dimensions only, the vectors stay empty
+    std::span<const uint8_t> table;
+    std::span<const uint8_t> indices;
+    unsigned bits_per_index = 0;
+    size_t rows_per_block = 0;
+    std::span<const uint8_t> block_offsets;
+};
+
 #endif
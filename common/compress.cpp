@@ -0,0 +1,80 @@
+#include "compress.hpp"
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#include <helpers/helpers.hpp>
+#include <helpers/stats.hpp>
+
+constexpr static int MaxByteValue = 255;
+constexpr static unsigned BYTE_BITS = 8;
+constexpr static unsigned WORD_BITS = 16;
+constexpr static unsigned RGB_CHANNELS = 3;
+
+namespace {
+    // Channel width of the packed color table entries, see CompressedImage
+    unsigned color_bits(const int max_color_value) {return max_color_value <= MaxByteValue ? BYTE_BITS : WORD_BITS;}
+
+    template <typename Channel>
+    uint64_t pack_table_color(const BasicPixel<Channel>& pixel, const unsigned bits) {
+        return (static_cast<uint64_t>(pixel.r) << (2 * bits)) | (static_cast<uint64_t>(pixel.g) << bits) |
+               static_cast<uint64_t>(pixel.b);
+    }
+
+    template <typename Channel>
+    std::vector<uint64_t> pack_pixels(std::span<const BasicPixel<Channel>> pixels, const unsigned bits) {
+        std::vector<uint64_t> keys(pixels.size());
+        parallelFor(pixels.size(), [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {keys[i] = pack_table_color(pixels[i], bits);}
+        });
+        return keys;
+    }
+
+    // Color table ranks of a sorted key run: every chunk first counts the colors
+    // that start in it, then writes its table entries and the pixels' indices
+    void assign_ranks(std::span<const uint64_t> sorted, std::span<const uint32_t> order, CompressedImage& compressed) {
+        const size_t chunks = parallelWorkers(sorted.size());
+        std::vector<size_t> chunk_start(chunks + 1, 0);
+        const auto starts_color = [&sorted](size_t i) { return i == 0 || sorted[i] != sorted[i - 1]; };
+        parallelForChunks(sorted.size(), [&](size_t chunk, size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {if (starts_color(i)) {++chunk_start[chunk + 1];}}
+        });
+        std::partial_sum(chunk_start.begin(), chunk_start.end(), chunk_start.begin());
+        compressed.color_table.resize(chunk_start.back());
+        compressed.pixel_indices.resize(sorted.size());
+        parallelForChunks(sorted.size(), [&](size_t chunk, size_t first, size_t last) {
+            size_t rank = chunk_start[chunk];
+            for (size_t i = first; i < last; ++i) {
+                if (starts_color(i)) {compressed.color_table[rank++] = sorted[i];}
+                compressed.pixel_indices[order[i]] = static_cast<uint32_t>(rank - 1);
+            }
+        });
+    }
+}
+
+template <typename Channel>
+CompressedImage compress_image(const BasicImage<Channel>& image) {
+    const ScopedTimer timer("compress");
+    // Pixel positions are sorted as 32-bit payloads and stored as 32-bit
+    // indices; checked before any per-pixel buffer is allocated
+    if (static_cast<uint64_t>(image.width) * static_cast<uint64_t>(image.height) > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Error: compress supports images of at most 4294967295 pixels");
+    }
+    const unsigned bits = color_bits(image.max_color_value);
+    std::vector<uint64_t> keys = pack_pixels(std::span(image.pixels), bits);
+    // Sorting pixel positions along with the colors lets every pixel learn its
+    // table index from one scan instead of a search
+    std::vector<uint32_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0U);
+    parallelRadixSort(keys, order, RGB_CHANNELS * bits);
+    CompressedImage compressed{.width=image.width, .height=image.height, .max_color=image.max_color_value,
+                               .color_table={}, .pixel_indices={}};
+    assign_ranks(keys, order, compressed);
+    addStatCounter("compress.unique_colors", compressed.color_table.size());
+    return compressed;
+}
+
+template CompressedImage compress_image(const BasicImage<uint8_t>& image);
+template CompressedImage compress_image(const BasicImage<uint16_t>& image);
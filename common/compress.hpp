@@ -0,0 +1,13 @@
+#ifndef COMPRESS_HPP
+#define COMPRESS_HPP
+
+#include "image_types.hpp"
+
+// Converts an image into its CPPM form: the unique colors sorted by packed
+// value (so the table is the same for every run and thread count) and, for
+// every pixel, the index of its color in that table.
+// Instantiated for 8-bit and 16-bit channels.
+template <typename Channel>
+CompressedImage compress_image(const BasicImage<Channel>& image);
+
+#endif // COMPRESS_HPP
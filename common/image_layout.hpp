@@ -0,0 +1,53 @@
+#ifndef IMAGE_LAYOUT_HPP
+#define IMAGE_LAYOUT_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "binaryio.hpp"
+#include "image_types.hpp"
+#include "resize_plan.hpp"
+
+// Compile-time pixel layout policies. A layout names its image type for a
+// channel type and moves images between that layout and the interleaved
+// BasicImage that binaryio reads and writes:
+//   template <typename Channel> using image = ...;
+//   static constexpr std::string_view NAME;
+//   static constexpr ResizeMethod DEFAULT_RESIZE;
+//   static image<Channel> from_interleaved(const BasicImage<Channel>&);
+//   static BasicImage<Channel> to_interleaved(const image<Channel>&, int max_color_value);
+//   static image<Channel> resize(const image<Channel>&, int new_width, int new_height, ResizeMethod);
+//   static void cutfreq(image<Channel>&, int frequency_threshold);
+// AosLayout (imgaos), SoaLayout (imgsoa) and TiledLayout (tiled_image.hpp)
+// implement it; the imtool pipeline (pipeline.hpp) is written once against it.
+template <typename Layout, typename Channel>
+using LayoutImage = typename Layout::template image<Channel>;
+
+template <typename Layout, typename Channel>
+concept ImageLayoutFor = requires(const BasicImage<Channel>& interleaved, LayoutImage<Layout, Channel>& image,
+                                  int size, ResizeMethod method) {
+    { Layout::NAME } -> std::convertible_to<std::string_view>;
+    { Layout::DEFAULT_RESIZE } -> std::convertible_to<ResizeMethod>;
+    { Layout::from_interleaved(interleaved) } -> std::same_as<LayoutImage<Layout, Channel>>;
+    { Layout::to_interleaved(std::as_const(image), size) } -> std::same_as<BasicImage<Channel>>;
+    { Layout::resize(std::as_const(image), size, size, method) } -> std::same_as<LayoutImage<Layout, Channel>>;
+    Layout::cutfreq(image, size);
+};
+
+// A layout for both depths read_ppm_native produces
+template <typename Layout>
+concept ImageLayout = ImageLayoutFor<Layout, uint8_t> && ImageLayoutFor<Layout, uint16_t>;
+
+// A layout that can also resize from a PpmStripReader straight into a PPM
+// file, holding a few rows at a time, with its STREAMING_RESIZE filter:
+//   static constexpr ResizeMethod STREAMING_RESIZE;
+//   static void resize_streaming(PpmStripReader&, const std::string& output_path, int new_width, int new_height);
+template <typename Layout>
+concept StreamingLayout = ImageLayout<Layout> && requires(PpmStripReader& reader, const std::string& path, int size) {
+    { Layout::STREAMING_RESIZE } -> std::convertible_to<ResizeMethod>;
+    Layout::resize_streaming(reader, path, size, size);
+};
+
+#endif // IMAGE_LAYOUT_HPP
@@ -2,24 +2,75 @@
 #define IMAGE_TYPES_HPP
 
 #include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <span>
+#include <type_traits>
+#include <variant>
 constexpr static int MAGICNUMB = 255;
-struct Pixel {
-    uint16_t r, g, b;
+constexpr static size_t PIXEL_CHANNELS = 3;
+
+// Interleaved pixel and image, templated on the channel storage type
+template <typename Channel>
+struct BasicPixel {
+    Channel r, g, b;
 };
 
-struct Image {
+template <typename Channel>
+struct BasicImage {
     int width = 0;
     int height = 0;
     int max_color_value = MAGICNUMB;
-    std::vector<Pixel> pixels;
+    std::vector<BasicPixel<Channel>> pixels;
+
+    // The width pixels of row y
+    std::span<BasicPixel<Channel>> row(const int y) {
+        return std::span(pixels).subspan(static_cast<size_t>(y) * static_cast<size_t>(width), static_cast<size_t>(width));
+    }
+    [[nodiscard]] std::span<const BasicPixel<Channel>> row(const int y) const {
+        return std::span(pixels).subspan(static_cast<size_t>(y) * static_cast<size_t>(width), static_cast<size_t>(width));
+    }
 };
 
+// A pixel of three channel members, named r, g, b (BasicPixel) or R, G, B
+// (BasicImageAOS::Pixel)
+template <typename PixelType>
+concept RgbPixel = requires(PixelType pixel) { pixel.r; } || requires(PixelType pixel) { pixel.R; };
+
+// The first channel of a pixel, with the constness of PixelType
+template <RgbPixel PixelType>
+auto& first_channel(PixelType& pixel) {
+    if constexpr (requires { pixel.r; }) {
+        return pixel.r;
+    } else {
+        return pixel.R;
+    }
+}
+
+// Interleaved samples of a pixel array, in memory order
+template <RgbPixel PixelType>
+auto pixel_samples(std::span<PixelType> pixels) {
+    using Sample = std::remove_reference_t<decltype(first_channel(pixels.front()))>;
+    static_assert(std::is_standard_layout_v<PixelType>, "Pixel must be a standard-layout struct");
+    static_assert(sizeof(PixelType) == PIXEL_CHANNELS * sizeof(Sample), "Pixel must be three packed samples");
+    return std::span<Sample>(reinterpret_cast<Sample*>(pixels.data()), pixels.size() * PIXEL_CHANNELS);
+}
+
+using Pixel = BasicPixel<uint16_t>;
+using Image = BasicImage<uint16_t>;
+using Image8 = BasicImage<uint8_t>;
+using Image16 = BasicImage<uint16_t>;
+
+// An image stored at its native depth: 8-bit channels when max_color_value <= 255
+using AnyImage = std::variant<Image8, Image16>;
+
+// Colors are packed as 0xRRGGBB when max_color <= 255 and as 16 bits per
+// channel (R in bits 32-47) otherwise
 struct CompressedImage {
     int width = 0;
     int height = 0;
     int max_color = MAGICNUMB;
-    std::vector<uint32_t> color_table; // Stores unique colors in the image
+    std::vector<uint64_t> color_table; // Stores unique colors in the image
     std::vector<uint32_t> pixel_indices; // Compressed pixel data as indices to color_table
 };
 
@@ -0,0 +1,56 @@
+#include "index_runs.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+constexpr static unsigned VARINT_PAYLOAD_BITS = 7;
+constexpr static uint8_t VARINT_PAYLOAD_MASK = 0x7F;
+constexpr static uint8_t VARINT_CONTINUE = 0x80;
+constexpr static unsigned MAX_VARINT_SHIFT = 63;
+
+namespace {
+    void append_varint(uint64_t value, std::vector<uint8_t>& out) {
+        for (; value > VARINT_PAYLOAD_MASK; value >>= VARINT_PAYLOAD_BITS) {
+            out.push_back(static_cast<uint8_t>((value & VARINT_PAYLOAD_MASK) | VARINT_CONTINUE));
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Reads one varint at position and moves position past it
+    uint64_t read_varint(std::span<const uint8_t> encoded, size_t& position) {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift <= MAX_VARINT_SHIFT; shift += VARINT_PAYLOAD_BITS) {
+            if (position >= encoded.size()) {throw std::runtime_error("Error: Truncated index run");}
+            const uint8_t byte = encoded[position++];
+            value |= static_cast<uint64_t>(byte & VARINT_PAYLOAD_MASK) << shift;
+            if ((byte & VARINT_CONTINUE) == 0) {return value;}
+        }
+        throw std::runtime_error("Error: Invalid index run length");
+    }
+}
+
+void append_index_runs(std::span<const uint32_t> indices, std::vector<uint8_t>& out) {
+    for (size_t first = 0; first < indices.size();) {
+        size_t last = first + 1;
+        while (last < indices.size() && indices[last] == indices[first]) {++last;}
+        append_varint(last - first, out);
+        append_varint(indices[first], out);
+        first = last;
+    }
+}
+
+void decode_index_runs(std::span<const uint8_t> encoded, std::span<uint32_t> out) {
+    size_t position = 0;
+    size_t filled = 0;
+    while (position < encoded.size()) {
+        const uint64_t length = read_varint(encoded, position);
+        const uint64_t index = read_varint(encoded, position);
+        if (length == 0 || length > out.size() - filled || index > std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Error: Invalid index run");
+        }
+        std::fill_n(out.begin() + static_cast<std::ptrdiff_t>(filled), length, static_cast<uint32_t>(index));
+        filled += length;
+    }
+    if (filled != out.size()) {throw std::runtime_error("Error: Truncated index run");}
+}
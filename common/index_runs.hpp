@@ -0,0 +1,20 @@
+#ifndef INDEX_RUNS_HPP
+#define INDEX_RUNS_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Run-length code for palette index streams: every run of equal indices is
+// stored as two LEB128 varints, the run length followed by the index. Runs
+// never cross the end of the span being encoded, so spans encoded separately
+// can be decoded independently.
+
+// Appends the runs of indices to out
+void append_index_runs(std::span<const uint32_t> indices, std::vector<uint8_t>& out);
+
+// Decodes encoded into exactly out.size() indices; throws if the runs are
+// malformed or do not cover out exactly
+void decode_index_runs(std::span<const uint8_t> encoded, std::span<uint32_t> out);
+
+#endif // INDEX_RUNS_HPP
@@ -0,0 +1,71 @@
+#include "mapped_file.hpp"
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::MappedFile(const std::string& file_path) {
+    opened = map_file(file_path) || read_file(file_path);
+}
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(std::exchange(other.data, {})), buffer(std::move(other.buffer)),
+      mapping(std::exchange(other.mapping, nullptr)), mapping_size(std::exchange(other.mapping_size, 0)),
+      opened(std::exchange(other.opened, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        data = std::exchange(other.data, {});
+        buffer = std::move(other.buffer);
+        mapping = std::exchange(other.mapping, nullptr);
+        mapping_size = std::exchange(other.mapping_size, 0);
+        opened = std::exchange(other.opened, false);
+    }
+    return *this;
+}
+
+void MappedFile::release() noexcept {
+    if (mapping != nullptr) {munmap(mapping, mapping_size);}
+    mapping = nullptr;
+    mapping_size = 0;
+    data = {};
+    buffer.clear();
+}
+
+// Maps regular, non-empty files; anything else falls back to read_file
+bool MappedFile::map_file(const std::string& file_path) {
+    const int descriptor = open(file_path.c_str(), O_RDONLY);
+    if (descriptor < 0) {return false;}
+    struct stat info{};
+    if (fstat(descriptor, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+        close(descriptor);
+        return false;
+    }
+    const auto size = static_cast<size_t>(info.st_size);
+    void* const address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (address == MAP_FAILED) {return false;}
+    madvise(address, size, MADV_SEQUENTIAL);
+    mapping = address;
+    mapping_size = size;
+    data = std::span<const uint8_t>(static_cast<const uint8_t*>(address), size);
+    return true;
+}
+
+bool MappedFile::read_file(const std::string& file_path) {
+    std::ifstream file(file_path, std::ios::binary | std::ios::ate);
+    if (!file) {return false;}
+    const std::streamoff size = file.tellg();
+    if (size < 0) {return false;}
+    buffer.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+    buffer.resize(static_cast<size_t>(file.gcount()));
+    data = buffer;
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Read-only view of a whole file. The file is memory-mapped when possible and
+// otherwise read into an owned buffer with a single bulk read.
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string& file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] bool is_open() const { return opened; }
+    [[nodiscard]] std::span<const uint8_t> bytes() const { return data; }
+
+  private:
+    void release() noexcept;
+    bool map_file(const std::string& file_path);
+    bool read_file(const std::string& file_path);
+
+    std::span<const uint8_t> data;
+    std::vector<uint8_t> buffer;  // Only used when mapping is not possible
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    bool opened = false;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,107 @@
+#include "maxlevel.hpp"
+#include "simd_kernels.hpp"
+#include <algorithm>
+#include <limits>
+#include <helpers/helpers.hpp>
+#include <helpers/stats.hpp>
+
+constexpr static int MaxByteValue = 255;
+constexpr static size_t TABLE_SIZE_8BIT = 256;
+constexpr static size_t TABLE_SIZE_16BIT = 65536;
+constexpr static size_t STRIP_PIXELS = size_t{1} << 18U;
+
+namespace {
+    // Widens the table to the 32-bit entries the gathers read, with an entry
+    // for every value a Source sample can hold. Samples past the table are
+    // above the old maximum, so they take the clamped last entry.
+    template <typename Source>
+    std::vector<uint32_t> gather_table(const std::vector<uint16_t>& table) {
+        std::vector<uint32_t> entries(std::max(table.size(), size_t{std::numeric_limits<Source>::max()} + 1), table.back());
+        std::ranges::copy(table, entries.begin());
+        return entries;
+    }
+
+    template <typename Source, typename Target>
+    void apply_gather_table(const std::vector<uint32_t>& table, std::span<const Source> src, std::span<Target> dst) {
+        parallelFor(src.size(), [&](size_t first, size_t last) {
+            lookup_samples<Source, Target>(table, src.subspan(first, last - first), dst.subspan(first, last - first));
+        });
+    }
+
+    // Rescales the mapped raster straight into the samples of a new image
+    template <typename Target>
+    BasicImage<Target> rescale_raster(const MappedPpm& file, const int new_max_color_value) {
+        BasicImage<Target> image{.width=file.header.width, .height=file.header.height, .max_color_value=new_max_color_value, .pixels={}};
+        image.pixels.resize(static_cast<size_t>(image.width) * static_cast<size_t>(image.height));
+        const std::span<Target> samples = pixel_samples(std::span(image.pixels));
+        const std::vector<uint16_t> table = build_maxlevel_table(file.header.max_color_value, new_max_color_value);
+        if (file.header.max_color_value <= MaxByteValue) {
+            apply_gather_table(gather_table<uint8_t>(table), file.raster, samples);
+            return image;
+        }
+        const std::vector<uint32_t> entries = gather_table<uint16_t>(table);
+        parallelFor(samples.size(), [&](size_t first, size_t last) {
+            lookup_big_endian_samples<Target>(entries, file.raster.subspan(2 * first, 2 * (last - first)), samples.subspan(first, last - first));
+        });
+        return image;
+    }
+}
+
+std::vector<uint16_t> build_maxlevel_table(int max_color_value, int new_max_color_value) {
+    const size_t table_size = max_color_value > MaxByteValue ? TABLE_SIZE_16BIT : TABLE_SIZE_8BIT;
+    std::vector<uint16_t> table(table_size);
+    for (size_t sample = 0; sample < table_size; ++sample) {
+        const auto clamped = static_cast<int64_t>(std::min(static_cast<int>(sample), max_color_value));
+        table[sample] = static_cast<uint16_t>(clamped * new_max_color_value / max_color_value);
+    }
+    return table;
+}
+
+template <typename Source, typename Target>
+void apply_maxlevel(const std::vector<uint16_t>& table, std::span<const Source> src, std::span<Target> dst) {
+    apply_gather_table(gather_table<Source>(table), src, dst);
+}
+
+template <typename Target, typename Source>
+BasicImage<Target> maxlevel_image(const BasicImage<Source>& image, const int new_max_color_value) {
+    const ScopedTimer timer("maxlevel");
+    addStatCounter("maxlevel.pixels", image.pixels.size());
+    BasicImage<Target> rescaled{.width=image.width, .height=image.height, .max_color_value=new_max_color_value, .pixels={}};
+    rescaled.pixels.resize(image.pixels.size());
+    apply_maxlevel(build_maxlevel_table(image.max_color_value, new_max_color_value), pixel_samples(std::span(image.pixels)),
+                   pixel_samples(std::span(rescaled.pixels)));
+    return rescaled;
+}
+
+AnyImage read_ppm_maxlevel(const std::string& file_path, const int new_max_color_value) {
+    const MappedPpm file = map_ppm(file_path);
+    // Decoding and rescaling are one pass, timed as the decode
+    const ScopedTimer timer("read.decode");
+    addStatCounter("read.pixels", static_cast<uint64_t>(file.header.width) * static_cast<uint64_t>(file.header.height));
+    if (new_max_color_value <= MaxByteValue) {return rescale_raster<uint8_t>(file, new_max_color_value);}
+    return rescale_raster<uint16_t>(file, new_max_color_value);
+}
+
+void maxlevel_streaming(PpmStripReader& reader, const std::string& output_path, int new_max_color_value) {
+    const std::vector<uint32_t> table = gather_table<uint16_t>(build_maxlevel_table(reader.max_color_value(), new_max_color_value));
+    PpmStripWriter writer(output_path, reader.width(), reader.height(), new_max_color_value);
+    const size_t strip_rows = std::max<size_t>(1, STRIP_PIXELS / static_cast<size_t>(reader.width()));
+    std::vector<Pixel> strip(strip_rows * static_cast<size_t>(reader.width()));
+    while (reader.rows_remaining() > 0) {
+        const size_t rows = reader.read_rows(strip);
+        const std::span<Pixel> pixels = std::span<Pixel>(strip).first(rows * static_cast<size_t>(reader.width()));
+        const std::span<uint16_t> samples = pixel_samples(pixels);
+        apply_gather_table<uint16_t, uint16_t>(table, samples, samples);
+        writer.write_rows(pixels);
+    }
+    writer.finish();
+}
+
+template void apply_maxlevel(const std::vector<uint16_t>& table, std::span<const uint8_t> src, std::span<uint8_t> dst);
+template void apply_maxlevel(const std::vector<uint16_t>& table, std::span<const uint8_t> src, std::span<uint16_t> dst);
+template void apply_maxlevel(const std::vector<uint16_t>& table, std::span<const uint16_t> src, std::span<uint8_t> dst);
+template void apply_maxlevel(const std::vector<uint16_t>& table, std::span<const uint16_t> src, std::span<uint16_t> dst);
+template BasicImage<uint8_t> maxlevel_image(const BasicImage<uint8_t>& image, int new_max_color_value);
+template BasicImage<uint16_t> maxlevel_image(const BasicImage<uint8_t>& image, int new_max_color_value);
+template BasicImage<uint8_t> maxlevel_image(const BasicImage<uint16_t>& image, int new_max_color_value);
+template BasicImage<uint16_t> maxlevel_image(const BasicImage<uint16_t>& image, int new_max_color_value);
@@ -0,0 +1,35 @@
+#ifndef MAXLEVEL_HPP
+#define MAXLEVEL_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "binaryio.hpp"
+
+// Lookup table that rescales every storable sample from max_color_value to
+// new_max_color_value (sample * new_max / old_max, samples above the old
+// maximum are clamped to it)
+std::vector<uint16_t> build_maxlevel_table(int max_color_value, int new_max_color_value);
+
+// Rescales every sample of src into dst through the table (vectorized with
+// gathers, in parallel); samples past the end of the table take its last
+// entry. src and dst may be the same samples. Instantiated for 8 and 16-bit
+// sources and targets.
+template <typename Source, typename Target>
+void apply_maxlevel(const std::vector<uint16_t>& table, std::span<const Source> src, std::span<Target> dst);
+
+// Rescales an interleaved image; Target must be uint8_t when the new maximum
+// is at most 255 and uint16_t otherwise
+template <typename Target, typename Source>
+BasicImage<Target> maxlevel_image(const BasicImage<Source>& image, int new_max_color_value);
+
+// Reads a PPM file and rescales it in the same pass over the raster, so the
+// samples are never stored at their original depth. The result has 8-bit
+// channels when the new maximum is at most 255.
+AnyImage read_ppm_maxlevel(const std::string& file_path, int new_max_color_value);
+
+// Rescales a PPM strip by strip; memory use is proportional to the image width
+void maxlevel_streaming(PpmStripReader& reader, const std::string& output_path, int new_max_color_value);
+
+#endif // MAXLEVEL_HPP
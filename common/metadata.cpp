@@ -1,10 +1,19 @@
 // metadata.cpp
 #include "metadata.hpp"
+#include "binaryio.hpp"
 
-Metadata get_metadata(const Image& image) {
+template <typename Channel>
+Metadata get_metadata(const BasicImage<Channel>& image) {
     Metadata metadata {};
     metadata.width = image.width;
     metadata.height = image.height;
     metadata.maxColorValue = image.max_color_value;
     return metadata;
 }
+
+template Metadata get_metadata(const BasicImage<uint8_t>& image);
+template Metadata get_metadata(const BasicImage<uint16_t>& image);
+
+Metadata get_metadata(const CompressedImageView& image) {
+    return Metadata{.width=image.width(), .height=image.height(), .maxColorValue=image.max_color()};
+}
@@ -18,7 +18,12 @@ struct Metadata {
     }
 };
 
-// Function declaration
-Metadata get_metadata(const Image& image);
+// Function declaration, instantiated for 8-bit and 16-bit channels
+template <typename Channel>
+Metadata get_metadata(const BasicImage<Channel>& image);
+
+class CompressedImageView;
+// Header of a compressed image, read without decoding its indices
+Metadata get_metadata(const CompressedImageView& image);
 
 #endif // METADATA_HPP
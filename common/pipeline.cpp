@@ -0,0 +1,108 @@
+#include "pipeline.hpp"
+#include "batch.hpp"
+#include "compress.hpp"
+#include "maxlevel.hpp"
+#include "metadata.hpp"
+#include <exception>
+#include <iostream>
+#include <helpers/helpers.hpp>
+
+AnyImage load_input(const ProgArgs& args) {
+    const Operation& first = args.getOperations().front();
+    const ScopedTimer timer("stage.read");
+    const ScopedAllocationStats allocations("stage.read");
+    if (first.name == "maxlevel") {return read_ppm_maxlevel(args.getInputFile(), std::stoi(first.params[0]));}
+    return read_ppm_native(args.getInputFile());
+}
+
+void finish_pipeline(const ProgArgs& args, const AnyImage& image) {
+    const ScopedTimer timer("stage.output");
+    const ScopedAllocationStats allocations("stage.output");
+    const Operation& last = args.getOperations().back();
+    std::visit([&](const auto& result) {
+        if (last.name == "info") {
+            std::cout << get_metadata(result).toString() << "\n";
+        } else if (last.name == "compress") {
+            const CppmIndexEncoding encoding = last.params.empty() ? CppmIndexEncoding::bytes : cppm_encoding_from_name(last.params[0]).value();
+            write_cppm(args.getOutputFile(), compress_image(result), encoding);
+        } else {
+            write_ppm(args.getOutputFile(), result);
+        }
+    }, image);
+}
+
+namespace {
+    // resize streams with the layout's streaming filter, maxlevel on any layout
+    bool streams_stage(const Operation& stage, const std::optional<ResizeMethod> streaming_resize) {
+        if (stage.name == "maxlevel") {return true;}
+        if (stage.name != "resize" || !streaming_resize) {return false;}
+        const std::vector<std::string>& params = stage.params;
+        return params.size() > 2 ? resize_filter_from_name(params[2]) == streaming_resize : true;
+    }
+}
+
+bool run_streaming(const ProgArgs& args, const std::optional<ResizeMethod> streaming_resize, const StreamingResize& resize) {
+    const std::vector<Operation>& stages = args.getOperations();
+    if (stages.size() != 1 || !streams_stage(stages.front(), streaming_resize)) {return false;}
+    if (!args.getInputFile().ends_with(".ppm") || !args.getOutputFile().ends_with(".ppm")) {return false;}
+    const std::vector<std::string>& params = stages.front().params;
+    const std::string timer_name = "stream." + stages.front().name;
+    const ScopedTimer timer(timer_name);
+    const ScopedAllocationStats allocations(timer_name);
+    PpmStripReader reader(args.getInputFile());
+    if (stages.front().name == "maxlevel") {
+        maxlevel_streaming(reader, args.getOutputFile(), std::stoi(params[0]));
+    } else {
+        resize(reader, args.getOutputFile(), std::stoi(params[0]), std::stoi(params[1]));
+    }
+    return true;
+}
+
+AnyImage run_maxlevel_stage(const Operation& stage, const AnyImage& image) {
+    const ScopedTimer timer("stage.maxlevel");
+    const ScopedAllocationStats allocations("stage.maxlevel");
+    const int new_max_color_value = std::stoi(stage.params[0]);
+    return std::visit([new_max_color_value](const auto& current) -> AnyImage {
+        if (new_max_color_value <= MAGICNUMB) {return maxlevel_image<uint8_t>(current, new_max_color_value);}
+        return maxlevel_image<uint16_t>(current, new_max_color_value);
+    }, image);
+}
+
+size_t layout_run_end(std::span<const Operation> stages, size_t first) {
+    while (first < stages.size() && (stages[first].name == "resize" || stages[first].name == "cutfreq")) {++first;}
+    return first;
+}
+
+bool print_compressed_info(const ProgArgs& args) {
+    if (args.getOperations().front().name != "info" || !args.getInputFile().ends_with(".cppm")) {return false;}
+    std::cout << get_metadata(CompressedImageView(args.getInputFile())).toString() << "\n";
+    return true;
+}
+
+namespace {
+    // Runs the pipeline, or every job of a batch; returns the number of failed jobs
+    size_t run_command(const ProgArgs& args, const std::function<void(const ProgArgs&)>& run_pipeline) {
+        const ScopedTimer timer("total");
+        if (args.getBatchManifest().empty()) {
+            run_pipeline(args);
+            return 0;
+        }
+        return run_batch(read_manifest(args.getBatchManifest()), static_cast<unsigned>(args.getJobs()), run_pipeline, std::cout);
+    }
+}
+
+int run_imtool_command(const int argc, const char* const* argv, const std::function<void(const ProgArgs&)>& run_pipeline) {
+    const ProgArgs args = ProgArgs::parse_arguments(argc, argv);
+    setThreadCount(static_cast<unsigned>(args.getThreads()));
+    setStatsEnabled(args.getStats());
+    setAllocationTracking(args.getTrackAllocations());
+    try {
+        const size_t failures = run_command(args, run_pipeline);
+        maxStatCounter("process.peak_rss_bytes", peakResidentBytes());
+        if (args.getStats()) {std::cout << statsReport() << "\n";}
+        if (failures != 0) {ProgArgs::display_error("Error: " + std::to_string(failures) + " batch jobs failed", -1);}
+    } catch (const std::exception& error) {
+        ProgArgs::display_error(error.what(), -1);
+    }
+    return 0;
+}
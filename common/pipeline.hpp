@@ -0,0 +1,118 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "binaryio.hpp"
+#include "image_layout.hpp"
+#include "progargs.hpp"
+#include "resize_plan.hpp"
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <helpers/alloc_tracking.hpp>
+#include <helpers/stats.hpp>
+
+// The imtool command line, written once against the layout policies of
+// image_layout.hpp: imtool-aos and imtool-soa are run_imtool<AosLayout> and
+// run_imtool<SoaLayout>, so the two differ only in the layout the stages run on.
+
+// Decodes the input; a leading maxlevel is folded into decoding the raster
+AnyImage load_input(const ProgArgs& args);
+
+// The last stage decides the output: info prints, compress encodes
+// straight into the CPPM writer, anything else writes a PPM
+void finish_pipeline(const ProgArgs& args, const AnyImage& image);
+
+// info on a CPPM input prints its metadata without decoding the raster;
+// returns whether it did
+bool print_compressed_info(const ProgArgs& args);
+
+// Parses the command line, then runs run_pipeline on it, or on every job of
+// a batch, and prints the stats report when asked to. Returns main's exit code.
+int run_imtool_command(int argc, const char* const* argv, const std::function<void(const ProgArgs&)>& run_pipeline);
+
+// Streaming resize of a layout, see StreamingLayout
+using StreamingResize = std::function<void(PpmStripReader&, const std::string&, int, int)>;
+
+// A job of a single maxlevel stage, or of a single resize stage with the
+// layout's streaming filter, from one .ppm file to another runs strip by
+// strip, so its memory use follows the image width rather than its area.
+// Returns whether the job was run this way.
+bool run_streaming(const ProgArgs& args, std::optional<ResizeMethod> streaming_resize, const StreamingResize& resize);
+
+// Runs a maxlevel stage on the interleaved image; it may change the depth
+AnyImage run_maxlevel_stage(const Operation& stage, const AnyImage& image);
+
+// End of the run of resize and cutfreq stages starting at first
+size_t layout_run_end(std::span<const Operation> stages, size_t first);
+
+// Runs one resize or cutfreq stage in place on an image already in Layout
+template <ImageLayout Layout, typename Channel>
+void run_layout_stage(const Operation& stage, LayoutImage<Layout, Channel>& image) {
+    const std::string timer_name = "stage." + stage.name;
+    const ScopedTimer timer(timer_name);
+    const ScopedAllocationStats allocations(timer_name);
+    const std::vector<std::string>& params = stage.params;
+    if (stage.name == "cutfreq") {
+        Layout::cutfreq(image, std::stoi(params[0]));
+        return;
+    }
+    const ResizeMethod method = params.size() > 2 ? resize_filter_from_name(params[2]).value() : Layout::DEFAULT_RESIZE;
+    image = Layout::resize(image, std::stoi(params[0]), std::stoi(params[1]), method);
+}
+
+// Converts the image to Layout once, runs a whole run of resize and cutfreq
+// stages on it and converts back once. The interleaved pixels are released
+// as soon as they are converted.
+template <ImageLayout Layout, typename Channel>
+BasicImage<Channel> run_layout_stages(std::span<const Operation> stages, BasicImage<Channel> image) {
+    auto converted = [&image] {
+        const ScopedTimer timer("layout.convert_in");
+        const ScopedAllocationStats allocations("layout.convert_in");
+        return Layout::from_interleaved(image);
+    }();
+    image.pixels = {};
+    for (const Operation& stage : stages) {run_layout_stage<Layout, Channel>(stage, converted);}
+    const ScopedTimer timer("layout.convert_out");
+    const ScopedAllocationStats allocations("layout.convert_out");
+    return Layout::to_interleaved(converted, image.max_color_value);
+}
+
+// Streams the job when run_streaming can, otherwise loads the input once and
+// runs every stage on it in memory. Consecutive resize and cutfreq stages
+// share one conversion to Layout; maxlevel, info and compress work on the
+// interleaved image.
+template <ImageLayout Layout>
+void run_layout_pipeline(const ProgArgs& args) {
+    if (print_compressed_info(args)) {return;}
+    if constexpr (StreamingLayout<Layout>) {
+        if (run_streaming(args, Layout::STREAMING_RESIZE, Layout::resize_streaming)) {return;}
+    } else {
+        if (run_streaming(args, std::nullopt, {})) {return;}
+    }
+    const std::vector<Operation>& stages = args.getOperations();
+    AnyImage image = load_input(args);
+    for (size_t i = stages.front().name == "maxlevel" ? 1 : 0; i < stages.size();) {
+        const size_t run_end = layout_run_end(stages, i);
+        if (run_end == i) {  // info and compress are left to finish_pipeline
+            if (stages[i].name == "maxlevel") {image = run_maxlevel_stage(stages[i], image);}
+            ++i;
+            continue;
+        }
+        const auto run = std::span(stages).subspan(i, run_end - i);
+        image = std::visit([run](auto& current) { return AnyImage(run_layout_stages<Layout>(run, std::move(current))); }, image);
+        i = run_end;
+    }
+    finish_pipeline(args, image);
+}
+
+template <ImageLayout Layout>
+int run_imtool(const int argc, const char* const* argv) {
+    return run_imtool_command(argc, argv, run_layout_pipeline<Layout>);
+}
+
+#endif // PIPELINE_HPP
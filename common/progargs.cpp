@@ -1,46 +1,140 @@
 #include "progargs.hpp"
+#include "binaryio.hpp"
+#include "resize_plan.hpp"
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
 #include <array>
+#include <iterator>
+#include <limits>
 #include <ranges>
+#include <string_view>
 
-constexpr static int MIN_ARGS = 3;
-constexpr static int MAXLEVEL_PARAM_INDEX = 4;
-constexpr static int RESIZE_PARAM_COUNT = 5;
-constexpr static int CUTFREQ_PARAM_COUNT = 4;
+constexpr static int MIN_ARGS = 4;  // Program name, input, output and operation
+constexpr static size_t MAXLEVEL_PARAM_COUNT = 1;
+constexpr static size_t RESIZE_PARAM_COUNT = 2;
+constexpr static size_t RESIZE_FILTER_PARAM_COUNT = 3;
+constexpr static size_t CUTFREQ_PARAM_COUNT = 1;
+constexpr static size_t COMPRESS_ENCODING_PARAM_COUNT = 1;
 constexpr static int MAX_COLOR_VALUE = 65535;
+constexpr static int MAX_THREADS = 1024;
+constexpr static std::string_view THREADS_OPTION = "--threads";
+constexpr static std::string_view BATCH_OPTION = "--batch";
+constexpr static std::string_view JOBS_OPTION = "--jobs";
+constexpr static std::string_view STATS_OPTION = "--stats";
+constexpr static std::string_view ALLOCATIONS_OPTION = "--track-allocations";
+constexpr static std::string_view STAGE_SEPARATOR = "+";
 
 ProgArgs ProgArgs::parse_arguments(int argc, const char* const* argv) {
-    if (argc < MIN_ARGS) {ProgArgs::display_error("Error: Invalid number of arguments: " + std::to_string(argc), -1);}
     ProgArgs parsedArgs;
-    parsedArgs.inputFile = argv[1];
-    parsedArgs.outputFile = argv[2];
-    parsedArgs.operation = argv[3];
-    for (int i = 4; i < argc; ++i) {parsedArgs.additionalParams.emplace_back(argv[i]);}
-    std::cout << "Additional parameters collected: ";
-    for (const auto& param : parsedArgs.additionalParams) {std::cout << param << " ";}
-    std::cout << "\n";
-    if (parsedArgs.operation == "info") {
-        if (argc != MIN_ARGS) {ProgArgs::display_error("Error: Invalid extra arguments for info.", -1);}
-    } else if (parsedArgs.operation == "maxlevel") {
-        if (argc != MAXLEVEL_PARAM_INDEX) {ProgArgs::display_error("Error: Invalid number of extra arguments for maxlevel.", -1);}
-        if (int const maxLevelValue = std::stoi(parsedArgs.additionalParams[0]); !isInteger(parsedArgs.additionalParams[0]) || maxLevelValue < 0 || maxLevelValue > MAX_COLOR_VALUE) {ProgArgs::display_error("Error: Invalid maxlevel: " + parsedArgs.additionalParams[0], -1);}
-    } else if (parsedArgs.operation == "resize") {
-        if (argc != RESIZE_PARAM_COUNT) {ProgArgs::display_error("Error: Invalid number of extra arguments for resize.", -1);}
-        int const resizeWidth = std::stoi(parsedArgs.additionalParams[0]);
-        const int resizeHeight = std::stoi(parsedArgs.additionalParams[1]);
-        if (!isInteger(parsedArgs.additionalParams[0]) || resizeWidth <= 0) {ProgArgs::display_error("Error: Invalid resize width: " + parsedArgs.additionalParams[0], -1);}
-        if (!isInteger(parsedArgs.additionalParams[1]) || resizeHeight <= 0) {ProgArgs::display_error("Error: Invalid resize height: " + parsedArgs.additionalParams[1], -1);}
-    } else if (parsedArgs.operation == "cutfreq") {
-        if (argc != CUTFREQ_PARAM_COUNT) {ProgArgs::display_error("Error: Invalid number of extra arguments for cutfreq.", -1);}
-        if (int const cutFreqValue = std::stoi(parsedArgs.additionalParams[0]); !isInteger(parsedArgs.additionalParams[0]) || cutFreqValue <= 0) {ProgArgs::display_error("Error: Invalid cutfreq: " + parsedArgs.additionalParams[0], -1);}
-    } else if (parsedArgs.operation == "compress") {
-        if (argc != MIN_ARGS) {ProgArgs::display_error("Error: Invalid extra arguments for compress.", -1);}
-    } else {ProgArgs::display_error("Error: Invalid option: " + parsedArgs.operation, -1);}
+    const std::vector<std::string> positional = parsedArgs.collect_options(argc, argv);
+    if (!parsedArgs.batchManifest.empty()) {
+        // The heap counters are process-wide, so concurrent jobs would count
+        // each other's allocations and reset each other's peaks
+        if (parsedArgs.trackAllocations && parsedArgs.jobs != 1) {ProgArgs::display_error("Error: --track-allocations in batch mode needs --jobs 1", -1);}
+        if (!positional.empty()) {ProgArgs::display_error("Error: --batch takes no input, output or operation arguments", -1);}
+        return parsedArgs;
+    }
+    if (positional.size() < MIN_ARGS - 1) {ProgArgs::display_error("Error: Invalid number of arguments: " + std::to_string(positional.size() + 1), -1);}
+    parsedArgs.inputFile = positional[0];
+    parsedArgs.outputFile = positional[1];
+    try {
+        parsedArgs.operations = split_stages(std::span(positional).subspan(MIN_ARGS - 2));
+        for (const Operation& stage : parsedArgs.operations) {validate_operation(stage);}
+        validate_pipeline(parsedArgs.operations);
+    } catch (const std::runtime_error& error) {
+        ProgArgs::display_error(error.what(), -1);
+    }
     return parsedArgs;
 }
 
+ProgArgs ProgArgs::parse_job(std::span<const std::string> words) {
+    if (words.size() < MIN_ARGS - 1) {throw std::runtime_error("Error: Invalid number of arguments: " + std::to_string(words.size()));}
+    ProgArgs job;
+    job.inputFile = words[0];
+    job.outputFile = words[1];
+    job.operations = split_stages(words.subspan(MIN_ARGS - 2));
+    for (const Operation& stage : job.operations) {validate_operation(stage);}
+    validate_pipeline(job.operations);
+    return job;
+}
+
+// Splits "op params... + op params..." into stages; every stage needs an operation name
+std::vector<Operation> ProgArgs::split_stages(std::span<const std::string> words) {
+    std::vector<Operation> stages(1);
+    for (const std::string& word : words) {
+        if (word == STAGE_SEPARATOR) {
+            stages.emplace_back();
+        } else if (stages.back().name.empty()) {
+            stages.back().name = word;
+        } else {
+            stages.back().params.push_back(word);
+        }
+    }
+    if (std::ranges::any_of(stages, [](const Operation& stage) { return stage.name.empty(); })) {throw std::runtime_error("Error: Missing operation in pipeline");}
+    return stages;
+}
+
+void ProgArgs::validate_operation(const Operation& stage) {
+    const std::vector<std::string>& params = stage.params;
+    const size_t paramCount = params.size();
+    if (stage.name == "info") {
+        if (paramCount != 0) {throw std::runtime_error("Error: Invalid extra arguments for info.");}
+    } else if (stage.name == "maxlevel") {
+        if (paramCount != MAXLEVEL_PARAM_COUNT) {throw std::runtime_error("Error: Invalid number of extra arguments for maxlevel.");}
+        if (!isInteger(params[0]) || std::stoi(params[0]) < 0 || std::stoi(params[0]) > MAX_COLOR_VALUE) {throw std::runtime_error("Error: Invalid maxlevel: " + params[0]);}
+    } else if (stage.name == "resize") {
+        if (paramCount != RESIZE_PARAM_COUNT && paramCount != RESIZE_FILTER_PARAM_COUNT) {throw std::runtime_error("Error: Invalid number of extra arguments for resize.");}
+        if (!isInteger(params[0]) || std::stoi(params[0]) <= 0) {throw std::runtime_error("Error: Invalid resize width: " + params[0]);}
+        if (!isInteger(params[1]) || std::stoi(params[1]) <= 0) {throw std::runtime_error("Error: Invalid resize height: " + params[1]);}
+        if (paramCount == RESIZE_FILTER_PARAM_COUNT && !resize_filter_from_name(params[2])) {throw std::runtime_error("Error: Invalid resize filter: " + params[2]);}
+    } else if (stage.name == "cutfreq") {
+        if (paramCount != CUTFREQ_PARAM_COUNT) {throw std::runtime_error("Error: Invalid number of extra arguments for cutfreq.");}
+        if (!isInteger(params[0]) || std::stoi(params[0]) <= 0) {throw std::runtime_error("Error: Invalid cutfreq: " + params[0]);}
+    } else if (stage.name == "compress") {
+        if (paramCount > COMPRESS_ENCODING_PARAM_COUNT) {throw std::runtime_error("Error: Invalid extra arguments for compress.");}
+        if (paramCount == COMPRESS_ENCODING_PARAM_COUNT && !cppm_encoding_from_name(params[0])) {throw std::runtime_error("Error: Invalid compress encoding: " + params[0]);}
+    } else {throw std::runtime_error("Error: Invalid option: " + stage.name);}
+}
+
+// info writes no image, so it runs alone; compress writes a CPPM file, so it ends the pipeline
+void ProgArgs::validate_pipeline(const std::vector<Operation>& stages) {
+    if (stages.size() == 1) {return;}
+    if (std::ranges::any_of(stages, [](const Operation& stage) { return stage.name == "info"; })) {throw std::runtime_error("Error: info cannot be combined with other operations");}
+    const auto compress = std::ranges::find(stages, "compress", &Operation::name);
+    if (compress != stages.end() && compress != std::prev(stages.end())) {throw std::runtime_error("Error: compress must be the last operation");}
+}
+
+// Strips "--threads N", "--batch manifest", "--jobs N", "--stats" and
+// "--track-allocations" from the command line and returns the remaining arguments
+std::vector<std::string> ProgArgs::collect_options(int argc, const char* const* argv) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view option = argv[i];
+        if (option == STATS_OPTION || option == ALLOCATIONS_OPTION) {
+            stats = true;
+            trackAllocations = trackAllocations || option == ALLOCATIONS_OPTION;
+            continue;
+        }
+        if (option != THREADS_OPTION && option != JOBS_OPTION && option != BATCH_OPTION) {
+            positional.emplace_back(argv[i]);
+            continue;
+        }
+        if (i + 1 >= argc) {ProgArgs::display_error("Error: Missing value for " + std::string(option), -1);}
+        const std::string value = argv[++i];
+        if (option == BATCH_OPTION) {
+            batchManifest = value;
+        } else if (!isInteger(value) || std::stoi(value) <= 0 || std::stoi(value) > MAX_THREADS) {
+            ProgArgs::display_error("Error: Invalid thread count for " + std::string(option), -1);
+        } else if (option == THREADS_OPTION) {
+            threads = std::stoi(value);
+        } else {
+            jobs = std::stoi(value);
+        }
+    }
+    return positional;
+}
+
 [[nodiscard]] std::string ProgArgs::getInputFile() const {
     return inputFile;
 }
@@ -50,15 +144,41 @@ ProgArgs ProgArgs::parse_arguments(int argc, const char* const* argv) {
 }
 
 [[nodiscard]] std::string ProgArgs::getOperation() const {
-    return operation;
+    if (operations.empty()) {throw std::runtime_error("Error: Batch arguments have no operation");}
+    return operations.front().name;
 }
 
 [[nodiscard]] std::vector<std::string> ProgArgs::getAdditionalParams() const {
-    return additionalParams;
+    if (operations.empty()) {throw std::runtime_error("Error: Batch arguments have no operation");}
+    return operations.front().params;
+}
+
+[[nodiscard]] const std::vector<Operation>& ProgArgs::getOperations() const {
+    return operations;
+}
+
+[[nodiscard]] int ProgArgs::getThreads() const {
+    return threads;
+}
+
+[[nodiscard]] std::string ProgArgs::getBatchManifest() const {
+    return batchManifest;
+}
+
+[[nodiscard]] int ProgArgs::getJobs() const {
+    return jobs;
+}
+
+[[nodiscard]] bool ProgArgs::getStats() const {
+    return stats;
+}
+
+[[nodiscard]] bool ProgArgs::getTrackAllocations() const {
+    return trackAllocations;
 }
 
 bool ProgArgs::isInteger(const std::string& str) {
-    return !str.empty() && std::ranges::all_of(str, ::isdigit);
+    return !str.empty() && str.size() < std::numeric_limits<int>::digits10 && std::ranges::all_of(str, ::isdigit);
 }
 
 void ProgArgs::display_error(const std::string& error_message, int error_code) {
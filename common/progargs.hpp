@@ -1,28 +1,59 @@
 #ifndef PROGARGS_HPP
 #define PROGARGS_HPP
 
+#include <span>
 #include <string>
 #include <vector>
 
+// One stage of a pipeline: an operation name and its extra arguments
+struct Operation {
+  std::string name;
+  std::vector<std::string> params;
+};
+
+// Operations are given as "input output op [params] [+ op [params]]...".
+// The stages run in order on one image loaded once; see the imtool mains.
+// "--batch manifest" replaces the positional arguments with one job per
+// manifest line, run by "--jobs N" workers; see batch.hpp. Batch mode takes
+// "--track-allocations" only with "--jobs 1", as the heap counters are shared.
 class ProgArgs {
   private:
   ProgArgs() = default;  // Private constructor to enforce static parsing
 
   std::string inputFile;
   std::string outputFile;
-  std::string operation;
-  std::vector<std::string> additionalParams;
+  std::vector<Operation> operations;
+  int threads = 0;  // 0 lets the parallel helpers use every hardware thread
+  std::string batchManifest;  // Empty outside batch mode
+  int jobs = 0;  // 0 runs one batch worker per hardware thread
+  bool stats = false;  // Print the helpers/stats.hpp report when done
+  bool trackAllocations = false;  // Adds per-stage heap use to the report; implies stats
 
   static bool isInteger(const std::string& str);  // Utility to validate integers
+  std::vector<std::string> collect_options(int argc, const char* const* argv);  // Consumes --threads, --batch, --jobs, --stats and --track-allocations
+  static std::vector<Operation> split_stages(std::span<const std::string> words);
+  static void validate_operation(const Operation& stage);
+  static void validate_pipeline(const std::vector<Operation>& stages);
 
   public:
   static ProgArgs parse_arguments(int argc, const char* const* argv);  // Factory method to parse arguments
+  // Parses "input output op [params]..." from a batch manifest line; throws
+  // std::runtime_error instead of exiting so one bad line fails one job
+  static ProgArgs parse_job(std::span<const std::string> words);
 
   // Getters for accessing parsed values
   [[nodiscard]] std::string getInputFile() const;
   [[nodiscard]] std::string getOutputFile() const;
+  // First stage; both throw std::runtime_error for --batch arguments, which
+  // have no stages of their own
   [[nodiscard]] std::string getOperation() const;
   [[nodiscard]] std::vector<std::string> getAdditionalParams() const;
+  [[nodiscard]] const std::vector<Operation>& getOperations() const;
+  [[nodiscard]] int getThreads() const;
+  [[nodiscard]] std::string getBatchManifest() const;
+  [[nodiscard]] int getJobs() const;
+  [[nodiscard]] bool getStats() const;
+  [[nodiscard]] bool getTrackAllocations() const;
 
   // Static utility function for error display
   static void display_error(const std::string& error_message, int error_code = -1);
@@ -0,0 +1,106 @@
+#include "resample.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <helpers/helpers.hpp>
+
+constexpr static int32_t FILTER_ROUNDING = FILTER_FIXED_ONE / 2;
+constexpr static int32_t MAX_16BIT = 65535;
+
+namespace {
+    // 8-bit sums fit in 32 bits; wider samples times negative-lobed weights may not
+    template <typename Channel>
+    using FilterAccumulator = std::conditional_t<std::is_same_v<Channel, uint8_t>, int32_t, int64_t>;
+
+    template <typename Channel>
+    constexpr int32_t channel_limit() {
+        if constexpr (std::is_same_v<Channel, int>) {
+            return MAX_16BIT;
+        } else {
+            return std::numeric_limits<Channel>::max();
+        }
+    }
+
+    // Rounded weighted sum of weights.size() samples that lie stride apart
+    template <typename Accumulator, typename Sample>
+    int32_t filter_sample(std::span<const Sample> samples, const size_t stride, std::span<const int32_t> weights) {
+        Accumulator sum = FILTER_ROUNDING;
+        for (size_t tap = 0; tap < weights.size(); ++tap) {
+            sum += static_cast<Accumulator>(samples[tap * stride]) * weights[tap];
+        }
+        return static_cast<int32_t>(sum >> FILTER_FIXED_BITS);
+    }
+
+    std::span<const int32_t> tap_weights(const ResizeAxis& axis, const size_t index) {
+        return std::span<const int32_t>(axis.filter_weight).subspan(index * axis.filter_taps, axis.filter_taps);
+    }
+
+    template <typename Channel>
+    struct ResampleJob {
+        std::span<const Channel> source;
+        std::span<Channel> output;
+        size_t channels;
+        const ResizePlan* plan;
+        // Horizontally filtered image, transposed: one row per destination column
+        std::vector<int32_t> intermediate;
+    };
+
+    template <typename Channel>
+    void filter_rows(ResampleJob<Channel>& job, const size_t first_row, const size_t last_row) {
+        const ResizeAxis& columns = job.plan->columns();
+        const auto source_width = static_cast<size_t>(job.plan->key().source_width);
+        const auto source_height = static_cast<size_t>(job.plan->key().source_height);
+        for (size_t row = first_row; row < last_row; ++row) {
+            for (size_t column = 0; column < columns.low.size(); ++column) {
+                const size_t first_sample = ((row * source_width) + static_cast<size_t>(columns.low[column])) * job.channels;
+                const size_t target = ((column * source_height) + row) * job.channels;
+                for (size_t channel = 0; channel < job.channels; ++channel) {
+                    job.intermediate[target + channel] = filter_sample<FilterAccumulator<Channel>>(
+                        job.source.subspan(first_sample + channel), job.channels, tap_weights(columns, column));
+                }
+            }
+        }
+    }
+
+    template <typename Channel>
+    void filter_columns(ResampleJob<Channel>& job, const size_t first_column, const size_t last_column) {
+        const ResizeAxis& rows = job.plan->rows();
+        const auto source_height = static_cast<size_t>(job.plan->key().source_height);
+        const auto new_width = static_cast<size_t>(job.plan->key().new_width);
+        const std::span<const int32_t> intermediate(job.intermediate);
+        for (size_t column = first_column; column < last_column; ++column) {
+            for (size_t row = 0; row < rows.low.size(); ++row) {
+                const size_t first_sample = ((column * source_height) + static_cast<size_t>(rows.low[row])) * job.channels;
+                const size_t target = ((row * new_width) + column) * job.channels;
+                for (size_t channel = 0; channel < job.channels; ++channel) {
+                    const int32_t value = filter_sample<int64_t>(intermediate.subspan(first_sample + channel), job.channels,
+                                                                 tap_weights(rows, row));
+                    job.output[target + channel] = static_cast<Channel>(std::clamp(value, 0, channel_limit<Channel>()));
+                }
+            }
+        }
+    }
+}
+
+template <typename Channel>
+void resample_filtered(std::span<const Channel> source, std::span<Channel> output, const size_t channels, const ResizePlan& plan) {
+    const ResizePlanKey& key = plan.key();
+    const auto source_height = static_cast<size_t>(key.source_height);
+    const auto new_width = static_cast<size_t>(key.new_width);
+    ResampleJob<Channel> job{.source=source, .output=output, .channels=channels, .plan=&plan,
+                             .intermediate=std::vector<int32_t>(new_width * source_height * channels)};
+    const size_t row_bytes = new_width * channels * sizeof(int32_t);
+    parallelForBlocks(source_height, cacheBlockSize(source_height, row_bytes), [&job](size_t first, size_t last) {
+        filter_rows(job, first, last);
+    });
+    const size_t column_bytes = source_height * channels * sizeof(int32_t);
+    parallelForBlocks(new_width, cacheBlockSize(new_width, column_bytes), [&job](size_t first, size_t last) {
+        filter_columns(job, first, last);
+    });
+}
+
+template void resample_filtered(std::span<const int> source, std::span<int> output, size_t channels, const ResizePlan& plan);
+template void resample_filtered(std::span<const uint8_t> source, std::span<uint8_t> output, size_t channels, const ResizePlan& plan);
+template void resample_filtered(std::span<const uint16_t> source, std::span<uint16_t> output, size_t channels, const ResizePlan& plan);
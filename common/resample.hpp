@@ -0,0 +1,18 @@
+#ifndef RESAMPLE_HPP
+#define RESAMPLE_HPP
+
+#include <cstddef>
+#include <span>
+#include "resize_plan.hpp"
+
+// Resamples an image with the area or Lanczos-3 filter of plan, as two
+// separable 1-D passes. The horizontal pass writes its rows transposed into
+// an intermediate buffer, so the vertical pass also reads contiguous memory.
+// Samples are interleaved in groups of channels (1 for a structure-of-arrays
+// plane, 3 for array-of-structures pixels). Arithmetic is fixed point; results
+// are rounded and clamped to the channel's range (0..65535 for int channels).
+// Instantiated for int, uint8_t and uint16_t.
+template <typename Channel>
+void resample_filtered(std::span<const Channel> source, std::span<Channel> output, size_t channels, const ResizePlan& plan);
+
+#endif // RESAMPLE_HPP
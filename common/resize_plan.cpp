@@ -0,0 +1,145 @@
+#include "resize_plan.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+
+constexpr static size_t PLAN_CACHE_CAPACITY = 8;
+constexpr static double AREA_RADIUS = 0.5;
+constexpr static double LANCZOS_RADIUS = 3.0;
+
+namespace {
+    // Nearest source index for every destination coordinate
+    ResizeAxis nearest_axis(const int source_size, const int new_size) {
+        float const scale = static_cast<float>(source_size) / static_cast<float>(new_size);
+        ResizeAxis axis;
+        axis.low.resize(static_cast<size_t>(new_size));
+        for (size_t i = 0; i < axis.low.size(); ++i) {
+            auto const src = static_cast<int32_t>(std::round(static_cast<float>(i) * scale));
+            axis.low[i] = std::min(src, source_size - 1);
+        }
+        return axis;
+    }
+
+    // Neighboring source samples and interpolation weight for every destination coordinate
+    ResizeAxis bilinear_axis(const int source_size, const int new_size) {
+        float const scale = static_cast<float>(source_size) / static_cast<float>(new_size);
+        const auto size = static_cast<size_t>(new_size);
+        ResizeAxis axis{.low=std::vector<int32_t>(size), .high=std::vector<int32_t>(size),
+                        .weight=std::vector<float>(size), .fixed_weight=std::vector<int32_t>(size), .filter_taps=0, .filter_weight={}};
+        for (size_t i = 0; i < size; ++i) {
+            float const src = static_cast<float>(i) * scale;
+            int const low = static_cast<int>(std::floor(src));
+            axis.low[i] = low;
+            axis.high[i] = std::min(static_cast<int>(std::ceil(src)), source_size - 1);
+            axis.weight[i] = src - static_cast<float>(low);
+            axis.fixed_weight[i] = static_cast<int32_t>(std::lround(axis.weight[i] * static_cast<float>(RESIZE_FIXED_ONE)));
+        }
+        return axis;
+    }
+
+    // Filter response at distance x (in source samples, already divided by the filter scale)
+    double filter_response(const ResizeMethod method, const double distance) {
+        const double x = std::abs(distance);
+        if (method == ResizeMethod::area) {return x < AREA_RADIUS ? 1.0 : 0.0;}
+        if (x == 0.0) {return 1.0;}
+        if (x >= LANCZOS_RADIUS) {return 0.0;}
+        const double angle = std::numbers::pi * x;
+        return LANCZOS_RADIUS * std::sin(angle) * std::sin(angle / LANCZOS_RADIUS) / (angle * angle);
+    }
+
+    // Area weights are the exact overlap of each source sample with the
+    // destination sample's footprint, so they are integrated rather than sampled
+    double filter_weight(const ResizeMethod method, const double center, const double filter_scale, const int sample) {
+        if (method == ResizeMethod::area) {
+            const double half_width = AREA_RADIUS * filter_scale;
+            const double overlap = std::min(static_cast<double>(sample) + 1.0, center + half_width) -
+                                   std::max(static_cast<double>(sample), center - half_width);
+            return std::max(0.0, overlap);
+        }
+        return filter_response(method, (static_cast<double>(sample) + AREA_RADIUS - center) / filter_scale);
+    }
+
+    // Quantizes one destination sample's weights so they sum exactly to FILTER_FIXED_ONE
+    void quantize_weights(std::span<const double> weights, std::span<int32_t> fixed) {
+        double total = 0.0;
+        for (const double weight : weights) {total += weight;}
+        int32_t fixed_total = 0;
+        for (size_t tap = 0; tap < weights.size(); ++tap) {
+            fixed[tap] = static_cast<int32_t>(std::lround(weights[tap] / total * FILTER_FIXED_ONE));
+            fixed_total += fixed[tap];
+        }
+        *std::ranges::max_element(fixed) += FILTER_FIXED_ONE - fixed_total;
+    }
+
+    ResizeAxis filter_axis(const ResizeMethod method, const int source_size, const int new_size) {
+        const double scale = static_cast<double>(source_size) / static_cast<double>(new_size);
+        const double filter_scale = std::max(1.0, scale);
+        const double support = (method == ResizeMethod::area ? AREA_RADIUS : LANCZOS_RADIUS) * filter_scale;
+        // Every sample the support can reach, before folding the edges
+        const int reach = static_cast<int>(std::ceil(2.0 * support)) + 2;
+        ResizeAxis axis;
+        axis.filter_taps = static_cast<size_t>(std::min(reach, source_size));
+        const auto taps = static_cast<int>(axis.filter_taps);
+        axis.low.resize(static_cast<size_t>(new_size));
+        axis.filter_weight.resize(axis.low.size() * axis.filter_taps);
+        std::vector<double> weights(axis.filter_taps);
+        for (size_t i = 0; i < axis.low.size(); ++i) {
+            const double center = (static_cast<double>(i) + AREA_RADIUS) * scale;
+            const auto first = static_cast<int>(std::floor(center - support));
+            axis.low[i] = std::clamp(first, 0, source_size - taps);
+            std::ranges::fill(weights, 0.0);
+            // Samples beyond either edge are folded onto the nearest edge sample
+            for (int sample = first; sample < first + reach; ++sample) {
+                weights[static_cast<size_t>(std::clamp(sample, 0, source_size - 1) - axis.low[i])] +=
+                    filter_weight(method, center, filter_scale, sample);
+            }
+            quantize_weights(weights, std::span(axis.filter_weight).subspan(i * axis.filter_taps, axis.filter_taps));
+        }
+        return axis;
+    }
+
+    ResizeAxis build_axis(const ResizeMethod method, const int source_size, const int new_size) {
+        if (method == ResizeMethod::nearest) {return nearest_axis(source_size, new_size);}
+        if (method == ResizeMethod::bilinear) {return bilinear_axis(source_size, new_size);}
+        return filter_axis(method, source_size, new_size);
+    }
+
+    std::mutex plan_cache_mutex;
+    std::list<std::shared_ptr<const ResizePlan>> plan_cache;  // Most recently used first
+}
+
+std::optional<ResizeMethod> resize_filter_from_name(const std::string_view name) {
+    if (name == "area") {return ResizeMethod::area;}
+    if (name == "lanczos3") {return ResizeMethod::lanczos3;}
+    return std::nullopt;
+}
+
+ResizePlan::ResizePlan(const ResizePlanKey& key) : plan_key(key) {
+    if (key.source_width <= 0 || key.source_height <= 0 || key.new_width <= 0 || key.new_height <= 0) {
+        throw std::runtime_error("Error: Resize dimensions must be positive");
+    }
+    column_taps = build_axis(key.method, key.source_width, key.new_width);
+    row_taps = build_axis(key.method, key.source_height, key.new_height);
+}
+
+std::shared_ptr<const ResizePlan> cached_resize_plan(const ResizePlanKey& key) {
+    {
+        std::scoped_lock const lock(plan_cache_mutex);
+        const auto found = std::ranges::find_if(plan_cache, [&key](const auto& plan) { return plan->key() == key; });
+        if (found != plan_cache.end()) {
+            plan_cache.splice(plan_cache.begin(), plan_cache, found);
+            return plan_cache.front();
+        }
+    }
+    // Built outside the lock; two threads missing on the same key both build it
+    auto plan = std::make_shared<const ResizePlan>(key);
+    std::scoped_lock const lock(plan_cache_mutex);
+    plan_cache.push_front(plan);
+    if (plan_cache.size() > PLAN_CACHE_CAPACITY) {plan_cache.pop_back();}
+    return plan;
+}
@@ -0,0 +1,74 @@
+#ifndef RESIZE_PLAN_HPP
+#define RESIZE_PLAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Weight scale of the fixed-point bilinear paths: weights are integers in [0, RESIZE_FIXED_ONE]
+constexpr static int32_t RESIZE_FIXED_BITS = 11;
+constexpr static int32_t RESIZE_FIXED_ONE = 1 << RESIZE_FIXED_BITS;
+// Weight scale of the area and Lanczos filters, whose weights can be negative
+constexpr static int32_t FILTER_FIXED_BITS = 14;
+constexpr static int32_t FILTER_FIXED_ONE = 1 << FILTER_FIXED_BITS;
+
+enum class ResizeMethod : uint8_t {
+    nearest,
+    bilinear,
+    area,      // Box filter: every output sample averages the source area it covers
+    lanczos3,  // Windowed sinc with three lobes, widened by the reduction ratio
+};
+
+// Filter selected by name on the command line ("area" or "lanczos3")
+std::optional<ResizeMethod> resize_filter_from_name(std::string_view name);
+
+struct ResizePlanKey {
+    int source_width;
+    int source_height;
+    int new_width;
+    int new_height;
+    ResizeMethod method;
+
+    bool operator==(const ResizePlanKey&) const = default;
+};
+
+// Source taps of every destination coordinate along one axis. Nearest
+// neighbor only fills low; bilinear interpolates between low and high with
+// weight (float) or fixed_weight (RESIZE_FIXED_ONE units) towards high.
+// Area and Lanczos filters read filter_taps consecutive source samples from
+// low, weighted by filter_weight (filter_taps entries per destination
+// coordinate, in FILTER_FIXED_ONE units, summing exactly to FILTER_FIXED_ONE).
+// Taps that would fall outside the image are folded onto the edge samples.
+struct ResizeAxis {
+    std::vector<int32_t> low;
+    std::vector<int32_t> high;
+    std::vector<float> weight;
+    std::vector<int32_t> fixed_weight;
+    size_t filter_taps = 0;
+    std::vector<int32_t> filter_weight;
+};
+
+// Coordinate and weight tables of one resize, computed once so the resize
+// loops do no per-pixel coordinate math
+class ResizePlan {
+  public:
+    explicit ResizePlan(const ResizePlanKey& key);
+
+    [[nodiscard]] const ResizePlanKey& key() const { return plan_key; }
+    [[nodiscard]] const ResizeAxis& columns() const { return column_taps; }
+    [[nodiscard]] const ResizeAxis& rows() const { return row_taps; }
+
+  private:
+    ResizePlanKey plan_key;
+    ResizeAxis column_taps;
+    ResizeAxis row_taps;
+};
+
+// Plan for key from a small process-wide LRU cache, built on a miss.
+// Safe to call from several threads.
+std::shared_ptr<const ResizePlan> cached_resize_plan(const ResizePlanKey& key);
+
+#endif // RESIZE_PLAN_HPP
@@ -0,0 +1,442 @@
+#include "simd_kernels.hpp"
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__)
+  #include <immintrin.h>
+#endif
+
+constexpr static size_t SSE_U16_LANES = 8;
+constexpr static size_t SSE_U32_LANES = 4;
+constexpr static size_t AVX_U16_LANES = 16;
+constexpr static size_t AVX_U32_LANES = 8;
+constexpr static uint16_t LOW_BYTE_MASK = 0xFF;
+constexpr static int BYTE_BITS = 8;
+constexpr static int HALF_WORD_BITS = 16;
+constexpr static int BYTE_SHIFT = 3;
+constexpr static size_t SSE_BYTES = 16;
+constexpr static size_t MAX_BYTE_GROUP = 128;  // 16 bytes of 1-bit fields
+constexpr static unsigned MAX_GATHER_BITS = 25;
+constexpr static size_t RGB_CHANNELS = 3;
+constexpr static uint8_t SHUFFLE_ZERO = 0x80;  // pshufb clears bytes with the high bit set
+
+void narrow_u16_to_u8(std::span<uint16_t const> src, std::span<uint8_t> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i mask = _mm256_set1_epi16(static_cast<short>(LOW_BYTE_MASK));
+    for (; i + (2 * AVX_U16_LANES) <= src.size(); i += 2 * AVX_U16_LANES) {
+        const __m256i low = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src.subspan(i).data())), mask);
+        const __m256i high = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src.subspan(i + AVX_U16_LANES).data())), mask);
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.subspan(i).data()), packed);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i mask_128 = _mm_set1_epi16(static_cast<short>(LOW_BYTE_MASK));
+    for (; i + (2 * SSE_U16_LANES) <= src.size(); i += 2 * SSE_U16_LANES) {
+        const __m128i low = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(i).data())), mask_128);
+        const __m128i high = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(i + SSE_U16_LANES).data())), mask_128);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.subspan(i).data()), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < src.size(); ++i) {dst[i] = static_cast<uint8_t>(src[i] & LOW_BYTE_MASK);}
+}
+
+void store_u16_big_endian(std::span<uint16_t const> src, std::span<uint8_t> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + AVX_U16_LANES <= src.size(); i += AVX_U16_LANES) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src.subspan(i).data()));
+        const __m256i swapped = _mm256_or_si256(_mm256_slli_epi16(value, BYTE_BITS), _mm256_srli_epi16(value, BYTE_BITS));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.subspan(2 * i).data()), swapped);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE_U16_LANES <= src.size(); i += SSE_U16_LANES) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(i).data()));
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi16(value, BYTE_BITS), _mm_srli_epi16(value, BYTE_BITS));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.subspan(2 * i).data()), swapped);
+    }
+#endif
+    for (; i < src.size(); ++i) {
+        dst[2 * i] = static_cast<uint8_t>(src[i] >> BYTE_BITS);
+        dst[(2 * i) + 1] = static_cast<uint8_t>(src[i] & LOW_BYTE_MASK);
+    }
+}
+
+void load_u16_big_endian(std::span<uint8_t const> src, std::span<uint16_t> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + AVX_U16_LANES <= dst.size(); i += AVX_U16_LANES) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src.subspan(2 * i).data()));
+        const __m256i swapped = _mm256_or_si256(_mm256_slli_epi16(value, BYTE_BITS), _mm256_srli_epi16(value, BYTE_BITS));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.subspan(i).data()), swapped);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + SSE_U16_LANES <= dst.size(); i += SSE_U16_LANES) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(2 * i).data()));
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi16(value, BYTE_BITS), _mm_srli_epi16(value, BYTE_BITS));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.subspan(i).data()), swapped);
+    }
+#endif
+    for (; i < dst.size(); ++i) {
+        dst[i] = static_cast<uint16_t>((static_cast<unsigned>(src[2 * i]) << BYTE_BITS) | src[(2 * i) + 1]);
+    }
+}
+
+void pack_indices_u8(std::span<uint32_t const> src, std::span<uint8_t> dst) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi32(LOW_BYTE_MASK);
+    for (; i + (4 * SSE_U32_LANES) <= src.size(); i += 4 * SSE_U32_LANES) {
+        const auto load = [&src, &mask](size_t offset) {
+            return _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(offset).data())), mask);
+        };
+        const __m128i words_low = _mm_packs_epi32(load(i), load(i + SSE_U32_LANES));
+        const __m128i words_high = _mm_packs_epi32(load(i + (2 * SSE_U32_LANES)), load(i + (3 * SSE_U32_LANES)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.subspan(i).data()), _mm_packus_epi16(words_low, words_high));
+    }
+#endif
+    for (; i < src.size(); ++i) {dst[i] = static_cast<uint8_t>(src[i]);}
+}
+
+void pack_indices_u16(std::span<uint32_t const> src, std::span<uint8_t> dst) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + (2 * SSE_U32_LANES) <= src.size(); i += 2 * SSE_U32_LANES) {
+        // Sign-extending the low half makes the signed pack keep exactly those 16 bits
+        const auto load = [&src](size_t offset) {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(offset).data()));
+            return _mm_srai_epi32(_mm_slli_epi32(value, HALF_WORD_BITS), HALF_WORD_BITS);
+        };
+        const __m128i packed = _mm_packs_epi32(load(i), load(i + SSE_U32_LANES));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.subspan(2 * i).data()), packed);
+    }
+#endif
+    for (; i < src.size(); ++i) {
+        const auto index = static_cast<uint16_t>(src[i]);
+        std::memcpy(dst.subspan(2 * i).data(), &index, sizeof(index));
+    }
+}
+
+void widen_indices_u8(std::span<uint8_t const> src, std::span<uint32_t> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + AVX_U32_LANES <= dst.size(); i += AVX_U32_LANES) {
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src.subspan(i).data()));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.subspan(i).data()), _mm256_cvtepu8_epi32(bytes));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + (4 * SSE_U32_LANES) <= dst.size(); i += 4 * SSE_U32_LANES) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(i).data()));
+        const __m128i words_low = _mm_unpacklo_epi8(bytes, zero);
+        const __m128i words_high = _mm_unpackhi_epi8(bytes, zero);
+        auto* const out = reinterpret_cast<__m128i*>(dst.subspan(i).data());
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(words_low, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(words_low, zero));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(words_high, zero));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(words_high, zero));
+    }
+#endif
+    for (; i < dst.size(); ++i) {dst[i] = src[i];}
+}
+
+void widen_indices_u16(std::span<uint8_t const> src, std::span<uint32_t> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + AVX_U32_LANES <= dst.size(); i += AVX_U32_LANES) {
+        const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(2 * i).data()));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.subspan(i).data()), _mm256_cvtepu16_epi32(words));
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + (2 * SSE_U32_LANES) <= dst.size(); i += 2 * SSE_U32_LANES) {
+        const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(2 * i).data()));
+        auto* const out = reinterpret_cast<__m128i*>(dst.subspan(i).data());
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(words, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(words, zero));
+    }
+#endif
+    for (; i < dst.size(); ++i) {
+        uint16_t index = 0;
+        std::memcpy(&index, src.subspan(2 * i).data(), sizeof(index));
+        dst[i] = index;
+    }
+}
+
+namespace {
+    uint64_t low_bits_mask(const unsigned bits) {return (uint64_t{1} << bits) - 1;}
+
+    void pack_bits_scalar(std::span<uint32_t const> src, const unsigned bits, std::span<uint8_t> dst) {
+        uint64_t pending = 0;
+        unsigned pending_bits = 0;
+        size_t out = 0;
+        for (const uint32_t index : src) {
+            pending |= (index & low_bits_mask(bits)) << pending_bits;
+            pending_bits += bits;
+            for (; pending_bits >= BYTE_BITS; pending_bits -= BYTE_BITS, pending >>= BYTE_BITS) {
+                dst[out++] = static_cast<uint8_t>(pending);
+            }
+        }
+        if (pending_bits > 0) {dst[out] = static_cast<uint8_t>(pending);}
+    }
+
+    uint32_t unpack_bits_scalar(std::span<uint8_t const> src, const unsigned bits, const size_t index) {
+        const size_t first_bit = index * bits;
+        const size_t last_byte = ((first_bit + bits - 1) / BYTE_BITS) + 1;
+        uint64_t window = 0;
+        for (size_t byte = first_bit / BYTE_BITS; byte < last_byte; ++byte) {
+            window |= uint64_t{src[byte]} << ((byte - (first_bit / BYTE_BITS)) * BYTE_BITS);
+        }
+        return static_cast<uint32_t>((window >> (first_bit % BYTE_BITS)) & low_bits_mask(bits));
+    }
+
+#if defined(__SSE2__)
+    // Merges neighboring fields of width bits into fields of twice that width,
+    // halving the bytes in place: 32 bytes become 16 per step
+    void merge_bit_fields(std::span<uint8_t> bytes, const unsigned bits) {
+        const __m128i field_mask = _mm_set1_epi16(static_cast<short>(low_bits_mask(bits)));
+        for (size_t i = 0; i < bytes.size(); i += 2 * SSE_BYTES) {
+            const auto merge = [&](size_t offset) {
+                const __m128i pairs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.subspan(offset).data()));
+                const __m128i high = _mm_and_si128(_mm_srli_epi16(pairs, BYTE_BITS), field_mask);
+                return _mm_or_si128(_mm_and_si128(pairs, field_mask), _mm_sll_epi16(high, _mm_cvtsi32_si128(static_cast<int>(bits))));
+            };
+            const __m128i merged = _mm_packus_epi16(merge(i), merge(i + SSE_BYTES));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes.subspan(i / 2).data()), merged);
+        }
+    }
+#endif
+}
+
+void pack_indices_bits(std::span<uint32_t const> src, const unsigned bits, std::span<uint8_t> dst) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // 1, 2 and 4-bit fields fill 16 output bytes from a group of 16 * 8 / bits indices
+    if (bits == 1 || bits == 2 || bits == 4) {
+        const size_t group = SSE_BYTES * BYTE_BITS / bits;
+        std::array<uint8_t, MAX_BYTE_GROUP> bytes{};
+        for (; i + group <= src.size(); i += group) {
+            pack_indices_u8(src.subspan(i, group), bytes);
+            for (unsigned width = bits; width < BYTE_BITS; width *= 2) {
+                merge_bit_fields(std::span(bytes).first(group * bits / width), width);
+            }
+            std::memcpy(dst.subspan(i * bits / BYTE_BITS).data(), bytes.data(), SSE_BYTES);
+        }
+    }
+#endif
+    pack_bits_scalar(src.subspan(i), bits, dst.subspan(i * bits / BYTE_BITS));
+}
+
+void unpack_indices_bits(std::span<uint8_t const> src, const unsigned bits, const size_t first, std::span<uint32_t> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    // Every lane gathers the 4 bytes holding its field, which fits up to 25 bits at any bit offset
+    if (bits <= MAX_GATHER_BITS) {
+        const auto step = static_cast<int>(bits);
+        const __m256i lane_bits = _mm256_setr_epi32(0, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+        const __m256i field_mask = _mm256_set1_epi32(static_cast<int>(low_bits_mask(bits)));
+        const __m256i byte_mask = _mm256_set1_epi32(BYTE_BITS - 1);
+        const size_t gather_bytes = (((BYTE_BITS - 1) + ((AVX_U32_LANES - 1) * bits)) / BYTE_BITS) + sizeof(uint32_t);
+        for (; i + AVX_U32_LANES <= dst.size(); i += AVX_U32_LANES) {
+            const size_t start_bit = (first + i) * bits;
+            if ((start_bit / BYTE_BITS) + gather_bytes > src.size()) {break;}
+            const __m256i offsets = _mm256_add_epi32(lane_bits, _mm256_set1_epi32(static_cast<int>(start_bit % BYTE_BITS)));
+            const __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(src.subspan(start_bit / BYTE_BITS).data()),
+                                                         _mm256_srli_epi32(offsets, BYTE_SHIFT), 1);
+            const __m256i fields = _mm256_and_si256(_mm256_srlv_epi32(words, _mm256_and_si256(offsets, byte_mask)), field_mask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.subspan(i).data()), fields);
+        }
+    }
+#endif
+    for (; i < dst.size(); ++i) {dst[i] = unpack_bits_scalar(src, bits, first + i);}
+}
+
+namespace {
+#if defined(__AVX2__)
+    // Widens 8 consecutive samples to 32-bit lanes
+    template <typename Source>
+    __m256i load_u32_lanes(std::span<Source const> src) {
+        if constexpr (sizeof(Source) == 1) {
+            return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src.data())));
+        } else {
+            return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data())));
+        }
+    }
+
+    // Narrows 8 lanes that already fit in Target
+    template <typename Target>
+    void store_u32_lanes(const __m256i value, std::span<Target> dst) {
+        const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+        if constexpr (sizeof(Target) == 1) {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst.data()), _mm_packus_epi16(words, words));
+        } else {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.data()), words);
+        }
+    }
+#endif
+}
+
+template <typename Source, typename Target>
+void lookup_samples(std::span<uint32_t const> table, std::span<Source const> src, std::span<Target> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const auto* const entries = reinterpret_cast<const int*>(table.data());
+    for (; i + AVX_U32_LANES <= src.size(); i += AVX_U32_LANES) {
+        store_u32_lanes(_mm256_i32gather_epi32(entries, load_u32_lanes(src.subspan(i)), sizeof(uint32_t)), dst.subspan(i));
+    }
+#endif
+    for (; i < src.size(); ++i) {dst[i] = static_cast<Target>(table[src[i]]);}
+}
+
+template void lookup_samples(std::span<uint32_t const> table, std::span<uint8_t const> src, std::span<uint8_t> dst);
+template void lookup_samples(std::span<uint32_t const> table, std::span<uint8_t const> src, std::span<uint16_t> dst);
+template void lookup_samples(std::span<uint32_t const> table, std::span<uint16_t const> src, std::span<uint8_t> dst);
+template void lookup_samples(std::span<uint32_t const> table, std::span<uint16_t const> src, std::span<uint16_t> dst);
+
+template <typename Target>
+void lookup_big_endian_samples(std::span<uint32_t const> table, std::span<uint8_t const> src, std::span<Target> dst) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const auto* const entries = reinterpret_cast<const int*>(table.data());
+    for (; i + AVX_U32_LANES <= dst.size(); i += AVX_U32_LANES) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src.subspan(2 * i).data()));
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi16(value, BYTE_BITS), _mm_srli_epi16(value, BYTE_BITS));
+        store_u32_lanes(_mm256_i32gather_epi32(entries, _mm256_cvtepu16_epi32(swapped), sizeof(uint32_t)), dst.subspan(i));
+    }
+#endif
+    for (; i < dst.size(); ++i) {
+        dst[i] = static_cast<Target>(table[(static_cast<size_t>(src[2 * i]) << BYTE_BITS) | src[(2 * i) + 1]]);
+    }
+}
+
+template void lookup_big_endian_samples(std::span<uint32_t const> table, std::span<uint8_t const> src, std::span<uint8_t> dst);
+template void lookup_big_endian_samples(std::span<uint32_t const> table, std::span<uint8_t const> src, std::span<uint16_t> dst);
+
+namespace {
+#if defined(__SSSE3__)
+    using ShuffleMask = std::array<uint8_t, SSE_BYTES>;
+    using ShuffleMasks = std::array<std::array<ShuffleMask, RGB_CHANNELS>, RGB_CHANNELS>;
+
+    // masks[channel][chunk] moves the bytes of channel found in the chunk-th
+    // 16 bytes of 48 interleaved bytes to their place in 16 planar bytes
+    constexpr ShuffleMasks deinterleave_masks(const size_t sample_bytes) {
+        ShuffleMasks masks{};
+        for (size_t channel = 0; channel < RGB_CHANNELS; ++channel) {
+            for (size_t byte = 0; byte < SSE_BYTES; ++byte) {
+                const size_t sample = ((byte / sample_bytes) * RGB_CHANNELS) + channel;
+                const size_t source = (sample * sample_bytes) + (byte % sample_bytes);
+                for (size_t chunk = 0; chunk < RGB_CHANNELS; ++chunk) {
+                    masks.at(channel).at(chunk).at(byte) = source / SSE_BYTES == chunk ? static_cast<uint8_t>(source % SSE_BYTES) : SHUFFLE_ZERO;
+                }
+            }
+        }
+        return masks;
+    }
+
+    // masks[channel][chunk] moves the bytes of 16 planar bytes of channel to
+    // their place in the chunk-th 16 bytes of 48 interleaved bytes
+    constexpr ShuffleMasks interleave_masks(const size_t sample_bytes) {
+        ShuffleMasks masks{};
+        for (size_t chunk = 0; chunk < RGB_CHANNELS; ++chunk) {
+            for (size_t byte = 0; byte < SSE_BYTES; ++byte) {
+                const size_t target = (chunk * SSE_BYTES) + byte;
+                const size_t sample = target / sample_bytes;
+                const size_t source = ((sample / RGB_CHANNELS) * sample_bytes) + (target % sample_bytes);
+                for (size_t channel = 0; channel < RGB_CHANNELS; ++channel) {
+                    masks.at(channel).at(chunk).at(byte) = sample % RGB_CHANNELS == channel ? static_cast<uint8_t>(source) : SHUFFLE_ZERO;
+                }
+            }
+        }
+        return masks;
+    }
+
+    __m128i load_mask(const ShuffleMask& mask) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask.data()));
+    }
+#endif
+
+    // Vector part of deinterleave_rgb; returns the number of pixels it split
+    template <typename Sample>
+    size_t deinterleave_vector([[maybe_unused]] std::span<Sample const> samples,
+                               [[maybe_unused]] const std::array<std::span<Sample>, RGB_CHANNELS>& planes) {
+        size_t pixel = 0;
+#if defined(__SSSE3__)
+        if constexpr (sizeof(Sample) <= 2) {
+            constexpr size_t lanes = SSE_BYTES / sizeof(Sample);
+            constexpr static ShuffleMasks masks = deinterleave_masks(sizeof(Sample));
+            for (; pixel + lanes <= planes[0].size(); pixel += lanes) {
+                const size_t first = pixel * RGB_CHANNELS;
+                const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples.subspan(first).data()));
+                const __m128i middle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples.subspan(first + lanes).data()));
+                const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples.subspan(first + (2 * lanes)).data()));
+                for (size_t channel = 0; channel < RGB_CHANNELS; ++channel) {
+                    const auto& mask = masks.at(channel);
+                    const __m128i plane = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(low, load_mask(mask[0])), _mm_shuffle_epi8(middle, load_mask(mask[1]))),
+                                                       _mm_shuffle_epi8(high, load_mask(mask[2])));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(planes.at(channel).subspan(pixel).data()), plane);
+                }
+            }
+        }
+#endif
+        return pixel;
+    }
+
+    // Vector part of interleave_rgb; returns the number of pixels it joined
+    template <typename Sample>
+    size_t interleave_vector([[maybe_unused]] const std::array<std::span<Sample const>, RGB_CHANNELS>& planes,
+                             [[maybe_unused]] std::span<Sample> samples) {
+        size_t pixel = 0;
+#if defined(__SSSE3__)
+        if constexpr (sizeof(Sample) <= 2) {
+            constexpr size_t lanes = SSE_BYTES / sizeof(Sample);
+            constexpr static ShuffleMasks masks = interleave_masks(sizeof(Sample));
+            for (; pixel + lanes <= planes[0].size(); pixel += lanes) {
+                const __m128i red = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0].subspan(pixel).data()));
+                const __m128i green = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1].subspan(pixel).data()));
+                const __m128i blue = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2].subspan(pixel).data()));
+                for (size_t chunk = 0; chunk < RGB_CHANNELS; ++chunk) {
+                    const __m128i joined = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(red, load_mask(masks[0].at(chunk))),
+                                                                     _mm_shuffle_epi8(green, load_mask(masks[1].at(chunk)))),
+                                                        _mm_shuffle_epi8(blue, load_mask(masks[2].at(chunk))));
+                    const size_t first = (pixel * RGB_CHANNELS) + (chunk * lanes);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(samples.subspan(first).data()), joined);
+                }
+            }
+        }
+#endif
+        return pixel;
+    }
+}
+
+template <typename Sample>
+void deinterleave_rgb(std::span<Sample const> samples, std::span<Sample> red, std::span<Sample> green, std::span<Sample> blue) {
+    for (size_t i = deinterleave_vector(samples, {red, green, blue}); i < red.size(); ++i) {
+        red[i] = samples[i * RGB_CHANNELS];
+        green[i] = samples[(i * RGB_CHANNELS) + 1];
+        blue[i] = samples[(i * RGB_CHANNELS) + 2];
+    }
+}
+
+template <typename Sample>
+void interleave_rgb(std::span<Sample const> red, std::span<Sample const> green, std::span<Sample const> blue,
+                    std::span<Sample> samples) {
+    for (size_t i = interleave_vector<Sample>({red, green, blue}, samples); i < red.size(); ++i) {
+        samples[i * RGB_CHANNELS] = red[i];
+        samples[(i * RGB_CHANNELS) + 1] = green[i];
+        samples[(i * RGB_CHANNELS) + 2] = blue[i];
+    }
+}
+
+template void deinterleave_rgb(std::span<int const> samples, std::span<int> red, std::span<int> green, std::span<int> blue);
+template void deinterleave_rgb(std::span<uint8_t const> samples, std::span<uint8_t> red, std::span<uint8_t> green, std::span<uint8_t> blue);
+template void deinterleave_rgb(std::span<uint16_t const> samples, std::span<uint16_t> red, std::span<uint16_t> green, std::span<uint16_t> blue);
+template void interleave_rgb(std::span<int const> red, std::span<int const> green, std::span<int const> blue, std::span<int> samples);
+template void interleave_rgb(std::span<uint8_t const> red, std::span<uint8_t const> green, std::span<uint8_t const> blue,
+                             std::span<uint8_t> samples);
+template void interleave_rgb(std::span<uint16_t const> red, std::span<uint16_t const> green, std::span<uint16_t const> blue,
+                             std::span<uint16_t> samples);
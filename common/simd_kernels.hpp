@@ -0,0 +1,60 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Vectorized conversion kernels shared by the binary readers and writers.
+// Every kernel has an SSE2/AVX2 path and a scalar tail, so the results do not
+// depend on the instruction set the library was built for.
+// Destination spans must be large enough for the converted source.
+
+// Keeps the low byte of every 16-bit sample (same as sample & 0xFF)
+void narrow_u16_to_u8(std::span<uint16_t const> src, std::span<uint8_t> dst);
+
+// Stores every 16-bit sample as two big-endian bytes
+void store_u16_big_endian(std::span<uint16_t const> src, std::span<uint8_t> dst);
+
+// Reads big-endian byte pairs back into 16-bit samples
+void load_u16_big_endian(std::span<uint8_t const> src, std::span<uint16_t> dst);
+
+// Truncates 32-bit palette indices to 1 or 2 little-endian bytes
+void pack_indices_u8(std::span<uint32_t const> src, std::span<uint8_t> dst);
+void pack_indices_u16(std::span<uint32_t const> src, std::span<uint8_t> dst);
+
+// Widens 1 or 2-byte little-endian palette indices back to 32 bits,
+// filling every element of dst
+void widen_indices_u8(std::span<uint8_t const> src, std::span<uint32_t> dst);
+void widen_indices_u16(std::span<uint8_t const> src, std::span<uint32_t> dst);
+
+// Packs indices into a little-endian bit stream of bits (1..32) bits per
+// index, index i occupying stream bits [i * bits, (i + 1) * bits). dst must
+// hold ceil(src.size() * bits / 8) bytes; indices are masked to bits bits.
+// The vector path covers 1, 2 and 4 bits per index.
+void pack_indices_bits(std::span<uint32_t const> src, unsigned bits, std::span<uint8_t> dst);
+// Reads dst.size() indices starting at index first back from such a stream.
+// The vector path covers streams of up to 25 bits per index.
+void unpack_indices_bits(std::span<uint8_t const> src, unsigned bits, size_t first, std::span<uint32_t> dst);
+
+// dst[i] = table[src[i]], with an AVX2 gather path. table must have an entry
+// for every value in src, and every entry must fit in Target. Instantiated for
+// 8 and 16-bit sources and targets.
+template <typename Source, typename Target>
+void lookup_samples(std::span<uint32_t const> table, std::span<Source const> src, std::span<Target> dst);
+
+// Same for big-endian 16-bit samples, read as dst.size() byte pairs
+template <typename Target>
+void lookup_big_endian_samples(std::span<uint32_t const> table, std::span<uint8_t const> src, std::span<Target> dst);
+
+// Splits interleaved r, g, b samples into three planes of red.size() pixels,
+// and joins such planes back into interleaved samples. The vector path
+// shuffles 16 bytes of every plane per step with SSSE3 byte shuffles, for 8
+// and 16-bit samples. Instantiated for int, uint8_t and uint16_t samples.
+template <typename Sample>
+void deinterleave_rgb(std::span<Sample const> samples, std::span<Sample> red, std::span<Sample> green, std::span<Sample> blue);
+template <typename Sample>
+void interleave_rgb(std::span<Sample const> red, std::span<Sample const> green, std::span<Sample const> blue,
+                    std::span<Sample> samples);
+
+#endif // SIMD_KERNELS_HPP
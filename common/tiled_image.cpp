@@ -0,0 +1,174 @@
+#include "tiled_image.hpp"
+#include "resample.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <helpers/helpers.hpp>
+#include <helpers/stats.hpp>
+
+template <typename Channel>
+TiledImage<Channel>::TiledImage(const int width, const int height)
+    : pixels(static_cast<size_t>(width) * static_cast<size_t>(height)), width(width), height(height) {}
+
+template <typename Channel>
+int TiledImage<Channel>::tiles_across() const {
+    return (width + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+template <typename Channel>
+int TiledImage<Channel>::tiles_down() const {
+    return (height + TILE_SIZE - 1) / TILE_SIZE;
+}
+
+template <typename Channel>
+int TiledImage<Channel>::tile_width(const int tile_x) const {
+    return std::min(TILE_SIZE, width - (tile_x * TILE_SIZE));
+}
+
+template <typename Channel>
+int TiledImage<Channel>::tile_height(const int tile_y) const {
+    return std::min(TILE_SIZE, height - (tile_y * TILE_SIZE));
+}
+
+namespace {
+    // Index of the first pixel of a tile: full bands of tiles above it, then
+    // the tiles to its left, which all have the band's height
+    template <typename Channel>
+    size_t tile_offset(const TiledImage<Channel>& image, const int tile_x, const int tile_y) {
+        const auto band_start = static_cast<size_t>(tile_y) * TiledImage<Channel>::TILE_SIZE * static_cast<size_t>(image.width);
+        const auto band_offset = static_cast<size_t>(tile_x) * TiledImage<Channel>::TILE_SIZE * static_cast<size_t>(image.tile_height(tile_y));
+        return band_start + band_offset;
+    }
+
+    // Pixel index of the part of row y that lies in tile column tile_x
+    template <typename Channel>
+    size_t row_offset(const TiledImage<Channel>& image, const int tile_x, const int y) {
+        constexpr int tile_size = TiledImage<Channel>::TILE_SIZE;
+        return tile_offset(image, tile_x, y / tile_size) + (static_cast<size_t>(y % tile_size) * static_cast<size_t>(image.tile_width(tile_x)));
+    }
+}
+
+template <typename Channel>
+std::span<BasicPixel<Channel>> TiledImage<Channel>::tile(const int tile_x, const int tile_y) {
+    return std::span(pixels).subspan(tile_offset(*this, tile_x, tile_y),
+                                     static_cast<size_t>(tile_width(tile_x)) * static_cast<size_t>(tile_height(tile_y)));
+}
+
+template <typename Channel>
+std::span<const BasicPixel<Channel>> TiledImage<Channel>::tile(const int tile_x, const int tile_y) const {
+    return std::span(pixels).subspan(tile_offset(*this, tile_x, tile_y),
+                                     static_cast<size_t>(tile_width(tile_x)) * static_cast<size_t>(tile_height(tile_y)));
+}
+
+template <typename Channel>
+std::span<BasicPixel<Channel>> TiledImage<Channel>::row(const int tile_x, const int y) {
+    return std::span(pixels).subspan(row_offset(*this, tile_x, y), static_cast<size_t>(tile_width(tile_x)));
+}
+
+template <typename Channel>
+std::span<const BasicPixel<Channel>> TiledImage<Channel>::row(const int tile_x, const int y) const {
+    return std::span(pixels).subspan(row_offset(*this, tile_x, y), static_cast<size_t>(tile_width(tile_x)));
+}
+
+template <typename Channel>
+const BasicPixel<Channel>& TiledImage<Channel>::at(const int x, const int y) const {
+    return pixels[row_offset(*this, x / TILE_SIZE, y) + static_cast<size_t>(x % TILE_SIZE)];
+}
+
+template <typename Channel>
+void TiledImage<Channel>::cutfreq(const int frequency_threshold) {
+    const ScopedTimer timer("cutfreq");
+    addStatCounter("cutfreq.pixels", pixels.size());
+    // Colors are counted and replaced in place, so tile order does not matter
+    removeInfrequentColors(InterleavedColors<Channel>{.samples=pixel_samples(std::span(pixels))}, frequency_threshold);
+}
+
+template <typename Channel>
+TiledImage<Channel> to_tiled(const BasicImage<Channel>& image) {
+    TiledImage<Channel> tiled(image.width, image.height);
+    for (int y = 0; y < image.height; ++y) {
+        const auto source_row = image.row(y);
+        for (int tile_x = 0; tile_x < tiled.tiles_across(); ++tile_x) {
+            const auto run = tiled.row(tile_x, y);
+            const auto source_run = source_row.subspan(static_cast<size_t>(tile_x) * TiledImage<Channel>::TILE_SIZE, run.size());
+            std::copy(source_run.begin(), source_run.end(), run.begin());
+        }
+    }
+    return tiled;
+}
+
+template <typename Channel>
+BasicImage<Channel> from_tiled(const TiledImage<Channel>& image, const int max_color_value) {
+    BasicImage<Channel> converted{.width=image.width, .height=image.height, .max_color_value=max_color_value,
+                                  .pixels=std::vector<BasicPixel<Channel>>(image.pixels.size())};
+    for (int y = 0; y < image.height; ++y) {
+        const auto target_row = converted.row(y);
+        for (int tile_x = 0; tile_x < image.tiles_across(); ++tile_x) {
+            const auto run = image.row(tile_x, y);
+            std::copy(run.begin(), run.end(), target_row.subspan(static_cast<size_t>(tile_x) * TiledImage<Channel>::TILE_SIZE).begin());
+        }
+    }
+    return converted;
+}
+
+namespace {
+    // Nearest-neighbor interpolation, source coordinates come from the plan.
+    // Each worker fills whole bands of output tiles, one tile at a time.
+    template <typename Channel>
+    void resize_nearest(const TiledImage<Channel>& image, const ResizePlan& plan, TiledImage<Channel>& resized_image) {
+        constexpr int tile_size = TiledImage<Channel>::TILE_SIZE;
+        const std::vector<int32_t>& src_x = plan.columns().low;
+        const std::vector<int32_t>& src_y = plan.rows().low;
+        parallelForBlocks(static_cast<size_t>(resized_image.tiles_down()), 1, [&](size_t first_band, size_t last_band) {
+            for (auto tile_y = static_cast<int>(first_band); tile_y < static_cast<int>(last_band); ++tile_y) {
+                for (int tile_x = 0; tile_x < resized_image.tiles_across(); ++tile_x) {
+                    for (int y = tile_y * tile_size; y < (tile_y * tile_size) + resized_image.tile_height(tile_y); ++y) {
+                        const auto run = resized_image.row(tile_x, y);
+                        const int source_y = src_y[static_cast<size_t>(y)];
+                        for (size_t i = 0; i < run.size(); ++i) {
+                            run[i] = image.at(src_x[(static_cast<size_t>(tile_x) * tile_size) + i], source_y);
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // The filters run on an interleaved copy of the image
+    template <typename Channel>
+    TiledImage<Channel> resize_filtered(const TiledImage<Channel>& image, const ResizePlan& plan) {
+        const BasicImage<Channel> source = from_tiled(image, MAGICNUMB);  // The maximum does not take part
+        BasicImage<Channel> resized{.width=plan.key().new_width, .height=plan.key().new_height, .max_color_value=MAGICNUMB,
+                                    .pixels=std::vector<BasicPixel<Channel>>(static_cast<size_t>(plan.key().new_width) *
+                                                                             static_cast<size_t>(plan.key().new_height))};
+        resample_filtered(pixel_samples(std::span(source.pixels)), pixel_samples(std::span(resized.pixels)), PIXEL_CHANNELS, plan);
+        return to_tiled(resized);
+    }
+}
+
+template <typename Channel>
+TiledImage<Channel> resize_tiled(const TiledImage<Channel>& image, const int new_width, const int new_height,
+                                 const ResizeMethod method) {
+    if (method == ResizeMethod::bilinear) {throw std::runtime_error("Error: resize_tiled has no bilinear filter");}
+    const auto plan = cached_resize_plan({.source_width=image.width, .source_height=image.height, .new_width=new_width,
+                                          .new_height=new_height, .method=method});
+    const ScopedTimer timer("resize");
+    addStatCounter("resize.pixels", static_cast<size_t>(new_width) * static_cast<size_t>(new_height));
+    if (method != ResizeMethod::nearest) {return resize_filtered(image, *plan);}
+    TiledImage<Channel> resized_image(new_width, new_height);
+    resize_nearest(image, *plan, resized_image);
+    return resized_image;
+}
+
+template class TiledImage<int>;
+template class TiledImage<uint8_t>;
+template class TiledImage<uint16_t>;
+template TiledImage<int> to_tiled(const BasicImage<int>& image);
+template TiledImage<uint8_t> to_tiled(const BasicImage<uint8_t>& image);
+template TiledImage<uint16_t> to_tiled(const BasicImage<uint16_t>& image);
+template BasicImage<int> from_tiled(const TiledImage<int>& image, int max_color_value);
+template BasicImage<uint8_t> from_tiled(const TiledImage<uint8_t>& image, int max_color_value);
+template BasicImage<uint16_t> from_tiled(const TiledImage<uint16_t>& image, int max_color_value);
+template TiledImage<int> resize_tiled(const TiledImage<int>& image, int new_width, int new_height, ResizeMethod method);
+template TiledImage<uint8_t> resize_tiled(const TiledImage<uint8_t>& image, int new_width, int new_height, ResizeMethod method);
+template TiledImage<uint16_t> resize_tiled(const TiledImage<uint16_t>& image, int new_width, int new_height, ResizeMethod method);
@@ -0,0 +1,84 @@
+#ifndef TILED_IMAGE_HPP
+#define TILED_IMAGE_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "image_layout.hpp"
+#include "image_types.hpp"
+#include "resize_plan.hpp"
+
+// Image stored in square tiles of TILE_SIZE x TILE_SIZE pixels, tiles in
+// row-major order and pixels row-major inside each tile. Tiles on the right
+// and bottom edges are cut to the image instead of padded, so the pixel array
+// holds exactly width * height pixels. Instantiated for int, uint8_t and
+// uint16_t channels.
+template <typename Channel>
+class TiledImage {
+public:
+    constexpr static int TILE_SIZE = 64;
+
+    std::vector<BasicPixel<Channel>> pixels;
+    int width;
+    int height;
+
+    TiledImage(int width, int height);
+
+    [[nodiscard]] int tiles_across() const;
+    [[nodiscard]] int tiles_down() const;
+    // Width of the tiles in column tile_x and height of the tiles in row tile_y
+    [[nodiscard]] int tile_width(int tile_x) const;
+    [[nodiscard]] int tile_height(int tile_y) const;
+
+    // The tile_width(tile_x) * tile_height(tile_y) pixels of a tile
+    std::span<BasicPixel<Channel>> tile(int tile_x, int tile_y);
+    [[nodiscard]] std::span<const BasicPixel<Channel>> tile(int tile_x, int tile_y) const;
+    // The part of image row y that lies in tile column tile_x
+    std::span<BasicPixel<Channel>> row(int tile_x, int y);
+    [[nodiscard]] std::span<const BasicPixel<Channel>> row(int tile_x, int y) const;
+    [[nodiscard]] const BasicPixel<Channel>& at(int x, int y) const;
+
+    // Same as the other layouts: every tile is part of one color view
+    void cutfreq(int frequency_threshold);
+};
+
+// Conversions from and to the interleaved image used by common/binaryio,
+// copying one tile-wide run of a row at a time
+template <typename Channel>
+TiledImage<Channel> to_tiled(const BasicImage<Channel>& image);
+template <typename Channel>
+BasicImage<Channel> from_tiled(const TiledImage<Channel>& image, int max_color_value);
+
+// Nearest neighbor fills the output tile by tile; the area and Lanczos-3
+// filters run on an interleaved copy (bilinear is SOA only)
+template <typename Channel>
+TiledImage<Channel> resize_tiled(const TiledImage<Channel>& image, int new_width, int new_height,
+                                 ResizeMethod method = ResizeMethod::nearest);
+
+// Layout policy (image_layout.hpp) for tiled images
+struct TiledLayout {
+    template <typename Channel>
+    using image = TiledImage<Channel>;
+
+    constexpr static std::string_view NAME = "tiled";
+    constexpr static ResizeMethod DEFAULT_RESIZE = ResizeMethod::nearest;
+
+    template <typename Channel>
+    static TiledImage<Channel> from_interleaved(const BasicImage<Channel>& image) { return to_tiled(image); }
+    template <typename Channel>
+    static BasicImage<Channel> to_interleaved(const TiledImage<Channel>& image, const int max_color_value) {
+        return from_tiled(image, max_color_value);
+    }
+    template <typename Channel>
+    static TiledImage<Channel> resize(const TiledImage<Channel>& image, const int new_width, const int new_height,
+                                      const ResizeMethod method) {
+        return resize_tiled(image, new_width, new_height, method);
+    }
+    template <typename Channel>
+    static void cutfreq(TiledImage<Channel>& image, const int frequency_threshold) { image.cutfreq(frequency_threshold); }
+};
+
+static_assert(ImageLayout<TiledLayout>);
+
+#endif // TILED_IMAGE_HPP
@@ -0,0 +1,88 @@
+#include "alloc_tracking.hpp"
+#include "stats.hpp"
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include <sys/resource.h>
+
+constexpr static uint64_t KILOBYTE = 1024;  // getrusage reports ru_maxrss in kilobytes on Linux
+
+namespace {
+    std::atomic<uint64_t> allocation_count{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+    // Signed: blocks allocated before tracking was enabled may be freed while it is on
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_live_bytes{0};
+
+    void raisePeak(int64_t live) {
+        int64_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    // Sizes come from malloc_usable_size so that new and delete agree on them
+    void countAllocation(void* block) {
+        const size_t size = malloc_usable_size(block);
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        raisePeak(live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size));
+    }
+
+    void countRelease(void* block) {
+        live_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(block)), std::memory_order_relaxed);
+    }
+}
+
+// The array and nothrow forms of new and delete forward to these. Over-aligned
+// allocations keep the library versions and are not counted.
+void* operator new(std::size_t size) {
+    void* const block = std::malloc(size == 0 ? 1 : size);
+    if (block == nullptr) {throw std::bad_alloc();}
+    if (allocationTrackingEnabled()) {countAllocation(block);}
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    if (block == nullptr) {return;}
+    if (allocationTrackingEnabled()) {countRelease(block);}
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t /*size*/) noexcept {
+    operator delete(block);
+}
+
+void setAllocationTracking(bool enabled) {
+    allocationTrackingFlag.store(enabled, std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope()
+    : start_allocations(allocation_count.load(std::memory_order_relaxed)),
+      start_bytes(allocated_bytes.load(std::memory_order_relaxed)), start_live(live_bytes.load(std::memory_order_relaxed)),
+      outer_peak(peak_live_bytes.exchange(start_live, std::memory_order_relaxed)) {}
+
+AllocationScope::~AllocationScope() {
+    raisePeak(outer_peak);
+}
+
+AllocationTotals AllocationScope::totals() const {
+    const int64_t peak = peak_live_bytes.load(std::memory_order_relaxed) - start_live;
+    return {.allocations = allocation_count.load(std::memory_order_relaxed) - start_allocations,
+            .bytes = allocated_bytes.load(std::memory_order_relaxed) - start_bytes,
+            .peak_bytes = peak > 0 ? static_cast<uint64_t>(peak) : 0};
+}
+
+ScopedAllocationStats::~ScopedAllocationStats() {
+    if (!allocationTrackingEnabled()) {return;}
+    const AllocationTotals totals = scope.totals();
+    const std::string prefix(name);
+    addStatCounter(prefix + ".allocations", totals.allocations);
+    addStatCounter(prefix + ".allocated_bytes", totals.bytes);
+    maxStatCounter(prefix + ".peak_bytes", totals.peak_bytes);
+}
+
+uint64_t peakResidentBytes() {
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {return 0;}
+    return static_cast<uint64_t>(usage.ru_maxrss) * KILOBYTE;
+}
@@ -0,0 +1,66 @@
+#ifndef ALLOC_TRACKING_HPP
+#define ALLOC_TRACKING_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+// Opt-in heap accounting. alloc_tracking.cpp replaces the global operator
+// new and delete; while tracking is off they add a relaxed load to each call.
+// Counts are process-wide, so allocations made by pool workers on behalf of
+// a scope count towards it too. For the same reason scopes on concurrent,
+// unrelated threads would see each other's allocations, so batch mode only
+// tracks allocations with a single job worker.
+
+inline std::atomic<bool> allocationTrackingFlag{false};
+
+[[nodiscard]] inline bool allocationTrackingEnabled() { return allocationTrackingFlag.load(std::memory_order_relaxed); }
+void setAllocationTracking(bool enabled);
+
+struct AllocationTotals {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;       // Allocated in the scope, whether or not it was freed
+  uint64_t peak_bytes = 0;  // Highest live heap above the level at the start of the scope
+};
+
+// Heap use from construction up to totals(). Scopes may nest: each one sees
+// its own high-water mark, and the enclosing scope's is kept.
+class AllocationScope {
+public:
+  AllocationScope();
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+  AllocationScope(AllocationScope&&) = delete;
+  AllocationScope& operator=(AllocationScope&&) = delete;
+  ~AllocationScope();
+
+  [[nodiscard]] AllocationTotals totals() const;
+
+private:
+  uint64_t start_allocations;
+  uint64_t start_bytes;
+  int64_t start_live;
+  int64_t outer_peak;
+};
+
+// Adds its scope to the --stats report as <name>.allocations and
+// <name>.allocated_bytes (summed over every scope with the name) and
+// <name>.peak_bytes (the largest). The name must outlive the object.
+class ScopedAllocationStats {
+public:
+  explicit ScopedAllocationStats(std::string_view name) : name(name) {}
+  ScopedAllocationStats(const ScopedAllocationStats&) = delete;
+  ScopedAllocationStats& operator=(const ScopedAllocationStats&) = delete;
+  ScopedAllocationStats(ScopedAllocationStats&&) = delete;
+  ScopedAllocationStats& operator=(ScopedAllocationStats&&) = delete;
+  ~ScopedAllocationStats();
+
+private:
+  std::string_view name;
+  AllocationScope scope;
+};
+
+// Largest resident set size of the process so far, from getrusage
+[[nodiscard]] uint64_t peakResidentBytes();
+
+#endif // ALLOC_TRACKING_HPP
@@ -1,71 +1,354 @@
 #include "helpers.hpp"
-#include <cmath>
+#include "stats.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <limits>
+#include <thread>
 
-// Definition of calculateColorFrequencies
-std::map<std::tuple<int, int, int>, int> calculateColorFrequencies(
-    const ColorChannels& channels) {
-    std::map<std::tuple<int, int, int>, int> color_freq;
-    for (size_t i = 0; i < channels.R.size(); ++i) {
-        auto color = std::make_tuple(channels.R[i], channels.G[i], channels.B[i]);
-        color_freq[color]++;
+constexpr static int MAX_8BIT_CHANNEL = 255;
+constexpr static int BYTE_BITS = 8;
+constexpr static size_t DENSE_TABLE_SIZE = size_t{1} << 24U;
+constexpr static size_t DENSE_MIN_PIXELS = size_t{1} << 20U;
+constexpr static uint64_t NO_COLOR = std::numeric_limits<uint64_t>::max();
+constexpr static size_t MIN_PARALLEL_ITEMS = 256;
+constexpr static size_t CACHE_BLOCK_BYTES = size_t{256} << 10U;
+constexpr static size_t BLOCKS_PER_WORKER = 4;
+constexpr static unsigned RADIX_BITS = 8;
+constexpr static size_t RADIX_BUCKETS = size_t{1} << RADIX_BITS;
+
+namespace {
+    std::atomic<unsigned> configured_threads{0};
+
+    template <ColorView Colors>
+    bool fitsInEightBits(const Colors& colors) {
+        if constexpr (sizeof(typename Colors::Channel) == 1) {
+            return true;
+        } else {
+            for (size_t i = 0; i < colors.size(); ++i) {
+                const auto [red, green, blue] = unpackColor(colors.key(i));
+                if (std::max({red, green, blue}) > MAX_8BIT_CHANNEL) {return false;}
+            }
+            return true;
+        }
+    }
+
+    size_t denseIndex(uint64_t key) {
+        const auto [red, green, blue] = unpackColor(key);
+        return (static_cast<size_t>(red) << (2 * BYTE_BITS)) | (static_cast<size_t>(green) << BYTE_BITS) |
+               static_cast<size_t>(blue);
+    }
+
+    uint64_t denseKey(size_t index) {
+        constexpr size_t byte_mask = 0xFF;
+        return packColor(static_cast<int>(index >> (2 * BYTE_BITS)), static_cast<int>((index >> BYTE_BITS) & byte_mask),
+                         static_cast<int>(index & byte_mask));
+    }
+}
+
+template <ColorView Colors>
+ColorHistogram::ColorHistogram(const Colors& colors) {
+    // The dense table only pays off once zeroing 64 MiB is cheap relative to the image
+    if (colors.size() >= DENSE_MIN_PIXELS && fitsInEightBits(colors)) {
+        buildDense(colors);
+    } else {
+        buildHashed(colors);
+    }
+}
+
+// Workers count into the shared table with relaxed atomic increments
+template <ColorView Colors>
+void ColorHistogram::buildDense(const Colors& colors) {
+    dense = true;
+    dense_counts.assign(DENSE_TABLE_SIZE, 0);
+    std::atomic<size_t> new_colors{0};
+    parallelFor(colors.size(), [&](size_t first, size_t last) {
+        size_t local_new_colors = 0;
+        for (size_t i = first; i < last; ++i) {
+            const size_t index = denseIndex(colors.key(i));
+            if (std::atomic_ref<uint32_t>(dense_counts[index]).fetch_add(1, std::memory_order_relaxed) == 0) {++local_new_colors;}
+        }
+        new_colors += local_new_colors;
+    });
+    unique_colors = new_colors;
+}
+
+// Every worker fills its own table, which are then merged in worker order
+template <ColorView Colors>
+void ColorHistogram::buildHashed(const Colors& colors) {
+    std::vector<PackedColorMap<uint32_t>> partial(parallelWorkers(colors.size()));
+    parallelForChunks(colors.size(), [&](size_t chunk, size_t first, size_t last) {
+        PackedColorMap<uint32_t>& local = partial[chunk];
+        for (size_t i = first; i < last; ++i) {++local[colors.key(i)];}
+    });
+    hashed_counts = std::move(partial.front());
+    for (size_t chunk = 1; chunk < partial.size(); ++chunk) {
+        partial[chunk].forEach([this](uint64_t key, uint32_t freq) { hashed_counts[key] += freq; });
     }
-    return color_freq;
+    unique_colors = hashed_counts.size();
 }
 
-// Definition of getInfrequentColors
-std::vector<std::tuple<int, int, int>> getInfrequentColors(
-    const std::map<std::tuple<int, int, int>, int>& color_freq,
-    int frequency_threshold) {
-    std::vector<std::tuple<int, int, int>> infrequent_colors;
-    for (const auto& [color, freq] : color_freq) {
-        if (freq < frequency_threshold) {
-            infrequent_colors.push_back(color);
+uint32_t ColorHistogram::count(uint64_t key) const {
+    if (dense) {
+        const auto [red, green, blue] = unpackColor(key);
+        if (red > MAX_8BIT_CHANNEL || green > MAX_8BIT_CHANNEL || blue > MAX_8BIT_CHANNEL) {return 0;}
+        return dense_counts[denseIndex(key)];
+    }
+    const uint32_t* const freq = hashed_counts.find(key);
+    return freq == nullptr ? 0 : *freq;
+}
+
+std::vector<uint64_t> ColorHistogram::colors(bool frequent, int frequency_threshold) const {
+    const auto selected = [frequent, frequency_threshold](uint32_t freq) {
+        return freq != 0 && (static_cast<int64_t>(freq) >= frequency_threshold) == frequent;
+    };
+    std::vector<uint64_t> result;
+    if (dense) {
+        // Dense indices already ascend in (R, G, B) order
+        for (size_t i = 0; i < dense_counts.size(); ++i) {
+            if (selected(dense_counts[i])) {result.push_back(denseKey(i));}
         }
+        return result;
     }
-    return infrequent_colors;
-}
-
-// Definition of replaceInfrequentColors with ColorChannels struct
-void replaceInfrequentColors(
-    ColorChannels& channels,
-    const std::map<std::tuple<int, int, int>, int>& color_freq,
-    int frequency_threshold) {
-
-    for (size_t i = 0; i < channels.R.size(); ++i) {
-        auto color = std::make_tuple(channels.R[i], channels.G[i], channels.B[i]);
-        if (color_freq.at(color) < frequency_threshold) {
-            auto [newR, newG, newB] = findClosestColor(color, color_freq, frequency_threshold);
-            channels.R[i] = newR;
-            channels.G[i] = newG;
-            channels.B[i] = newB;
+    hashed_counts.forEach([&result, &selected](uint64_t key, uint32_t freq) {
+        if (selected(freq)) {result.push_back(key);}
+    });
+    std::ranges::sort(result);
+    return result;
+}
+
+NearestColorIndex::NearestColorIndex(std::span<const uint64_t> colors) {
+    nodes.reserve(colors.size());
+    for (const uint64_t key : colors) {
+        const auto [red, green, blue] = unpackColor(key);
+        nodes.push_back({.rgb={red, green, blue}, .key=key, .axis=0});
+    }
+    build(0, nodes.size());
+}
+
+// Splits every range at its median along the axis with the widest spread
+void NearestColorIndex::build(size_t first, size_t last) {
+    if (last - first <= 1) {return;}
+    const auto range = std::span(nodes).subspan(first, last - first);
+    int axis = 0;
+    int widest = -1;
+    for (int candidate = 0; candidate < 3; ++candidate) {
+        const auto [low, high] = std::ranges::minmax_element(range, {}, [candidate](const Node& node) { return node.rgb.at(static_cast<size_t>(candidate)); });
+        const int spread = high->rgb.at(static_cast<size_t>(candidate)) - low->rgb.at(static_cast<size_t>(candidate));
+        if (spread > widest) {
+            widest = spread;
+            axis = candidate;
         }
     }
+    const size_t mid = first + ((last - first) / 2);
+    std::ranges::nth_element(range, range.begin() + static_cast<std::ptrdiff_t>(mid - first), {},
+                             [axis](const Node& node) { return node.rgb.at(static_cast<size_t>(axis)); });
+    nodes[mid].axis = axis;
+    build(first, mid);
+    build(mid + 1, last);
+}
+
+void NearestColorIndex::search(size_t first, size_t last, const std::array<int, 3>& target, Best& best) const {
+    if (first >= last) {return;}
+    const size_t mid = first + ((last - first) / 2);
+    const Node& node = nodes[mid];
+    int64_t distance = 0;
+    for (size_t channel = 0; channel < 3; ++channel) {
+        const int64_t delta = target.at(channel) - node.rgb.at(channel);
+        distance += delta * delta;
+    }
+    if (distance < best.distance || (distance == best.distance && node.key < best.key)) {best = {.distance=distance, .key=node.key};}
+
+    const auto axis = static_cast<size_t>(node.axis);
+    const int64_t plane = target.at(axis) - node.rgb.at(axis);
+    const bool lower_first = plane < 0;
+    search(lower_first ? first : mid + 1, lower_first ? mid : last, target, best);
+    // A tie on the far side can still win on the key, so only strictly farther planes are pruned
+    if (plane * plane <= best.distance) {search(lower_first ? mid + 1 : first, lower_first ? last : mid, target, best);}
 }
 
-// Definition of findClosestColor
-std::tuple<int, int, int> findClosestColor(
-    const std::tuple<int, int, int>& color,
-    const std::map<std::tuple<int, int, int>, int>& color_freq,
-    int frequency_threshold) {
+std::tuple<int, int, int> NearestColorIndex::nearest(const std::tuple<int, int, int>& color) const {
+    if (nodes.empty()) {return {0, 0, 0};}
+    Best best{.distance=std::numeric_limits<int64_t>::max(), .key=NO_COLOR};
+    search(0, nodes.size(), {std::get<0>(color), std::get<1>(color), std::get<2>(color)}, best);
+    return unpackColor(best.key);
+}
 
-    double min_distance = std::numeric_limits<double>::max();
-    std::tuple<int, int, int> closest_color;
+void setThreadCount(unsigned count) {
+    configured_threads = count;
+}
+
+unsigned threadCount() {
+    const unsigned count = configured_threads;
+    return count != 0 ? count : std::max(1U, std::thread::hardware_concurrency());
+}
+
+size_t parallelWorkers(size_t count) {
+    return std::max<size_t>(1, std::min<size_t>(threadCount(), count / MIN_PARALLEL_ITEMS));
+}
+
+void parallelForChunks(size_t count, const std::function<void(size_t, size_t, size_t)>& body) {
+    const size_t workers = parallelWorkers(count);
+    if (workers == 1) {
+        body(0, 0, count);
+        return;
+    }
+    sharedThreadPool().run(workers, [count, workers, &body](size_t chunk) {
+        body(chunk, count * chunk / workers, count * (chunk + 1) / workers);
+    });
+}
+
+void parallelFor(size_t count, const std::function<void(size_t, size_t)>& body) {
+    parallelForChunks(count, [&body](size_t /*chunk*/, size_t first, size_t last) { body(first, last); });
+}
+
+size_t cacheBlockSize(size_t count, size_t bytes_per_item) {
+    const size_t cache_items = std::max<size_t>(1, CACHE_BLOCK_BYTES / std::max<size_t>(1, bytes_per_item));
+    const size_t balanced_items = std::max<size_t>(1, count / (static_cast<size_t>(threadCount()) * BLOCKS_PER_WORKER));
+    return std::min(cache_items, balanced_items);
+}
+
+void parallelForBlocks(size_t count, size_t block_size, const std::function<void(size_t, size_t)>& body) {
+    const size_t blocks = (count + block_size - 1) / block_size;
+    sharedThreadPool().run(blocks, [count, block_size, &body](size_t block) {
+        body(block * block_size, std::min(count, (block + 1) * block_size));
+    });
+}
+
+namespace {
+    using RadixCounts = std::array<size_t, RADIX_BUCKETS>;
+
+    size_t radixDigit(uint64_t key, unsigned shift) {
+        return static_cast<size_t>(key >> shift) & (RADIX_BUCKETS - 1);
+    }
+
+    // Per-chunk digit counts turned into each chunk's first output slot per
+    // digit; returns false when one digit holds every key and the pass can be skipped
+    bool radixOffsets(std::span<const uint64_t> keys, unsigned shift, std::vector<RadixCounts>& offsets) {
+        parallelForChunks(keys.size(), [&](size_t chunk, size_t first, size_t last) {
+            offsets[chunk].fill(0);
+            for (size_t i = first; i < last; ++i) {++offsets[chunk][radixDigit(keys[i], shift)];}
+        });
+        size_t total = 0;
+        for (size_t digit = 0; digit < RADIX_BUCKETS; ++digit) {
+            const size_t digit_start = total;
+            for (RadixCounts& counts : offsets) {
+                const size_t count = counts[digit];
+                counts[digit] = total;
+                total += count;
+            }
+            if (total - digit_start == keys.size()) {return false;}
+        }
+        return true;
+    }
+}
 
-    for (const auto& [frequent_color, freq] : color_freq) {
-        if (freq >= frequency_threshold) {
-            const double distance = std::sqrt(
-                std::pow(std::get<0>(color) - std::get<0>(frequent_color), 2) +
-                std::pow(std::get<1>(color) - std::get<1>(frequent_color), 2) +
-                std::pow(std::get<2>(color) - std::get<2>(frequent_color), 2)
-            );
-
-            if (distance < min_distance) {
-                min_distance = distance;
-                closest_color = frequent_color;
+void parallelRadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& payload, unsigned key_bits) {
+    std::vector<uint64_t> key_scratch(keys.size());
+    std::vector<uint32_t> payload_scratch(payload.size());
+    std::vector<RadixCounts> offsets(parallelWorkers(keys.size()));
+    for (unsigned shift = 0; shift < key_bits; shift += RADIX_BITS) {
+        if (!radixOffsets(keys, shift, offsets)) {continue;}
+        parallelForChunks(keys.size(), [&](size_t chunk, size_t first, size_t last) {
+            RadixCounts& next = offsets[chunk];
+            for (size_t i = first; i < last; ++i) {
+                const size_t target = next[radixDigit(keys[i], shift)]++;
+                key_scratch[target] = keys[i];
+                payload_scratch[target] = payload[i];
             }
+        });
+        keys.swap(key_scratch);
+        payload.swap(payload_scratch);
+    }
+}
+
+// Definition of calculateColorFrequencies
+template <ColorView Colors>
+ColorHistogram calculateColorFrequencies(const Colors& colors) {
+    const ScopedTimer timer("cutfreq.histogram");
+    ColorHistogram histogram(colors);
+    addStatCounter("cutfreq.unique_colors", histogram.size());
+    return histogram;
+}
+
+PackedColorMap<uint64_t> buildReplacementTable(const ColorHistogram& color_freq, int frequency_threshold) {
+    const ScopedTimer timer("cutfreq.nearest_colors");
+    const NearestColorIndex frequent_colors(color_freq.colors(true, frequency_threshold));
+    const std::vector<uint64_t> infrequent_colors = color_freq.colors(false, frequency_threshold);
+    addStatCounter("cutfreq.infrequent_colors", infrequent_colors.size());
+    std::vector<uint64_t> closest(infrequent_colors.size());
+    parallelFor(infrequent_colors.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const auto [red, green, blue] = frequent_colors.nearest(unpackColor(infrequent_colors[i]));
+            closest[i] = packColor(red, green, blue);
+        }
+    });
+    PackedColorMap<uint64_t> replacements(infrequent_colors.size());
+    for (size_t i = 0; i < infrequent_colors.size(); ++i) {replacements[infrequent_colors[i]] = closest[i];}
+    return replacements;
+}
+
+// Definition of replaceInfrequentColors, rewriting the view's pixels in place
+template <ColorView Colors>
+void replaceInfrequentColors(const Colors& colors, const ColorHistogram& color_freq, int frequency_threshold) {
+    const PackedColorMap<uint64_t> replacements = buildReplacementTable(color_freq, frequency_threshold);
+    if (replacements.size() == 0) {return;}
+    const ScopedTimer timer("cutfreq.replace");
+    parallelFor(colors.size(), [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            if (const uint64_t* const closest = replacements.find(colors.key(i))) {colors.set(i, *closest);}
+        }
+    });
+}
+
+template <ColorView Colors>
+void removeInfrequentColors(const Colors& colors, int frequency_threshold) {
+    replaceInfrequentColors(colors, calculateColorFrequencies(colors), frequency_threshold);
+}
+
+// Definition of findClosestColor, a linear scan kept as the reference for NearestColorIndex
+std::tuple<int, int, int> findClosestColor(const std::tuple<int, int, int>& color, std::span<const uint64_t> frequent_colors) {
+    int64_t min_distance = std::numeric_limits<int64_t>::max();
+    std::tuple<int, int, int> closest_color;
+
+    for (const uint64_t key : frequent_colors) {
+        const auto frequent_color = unpackColor(key);
+        const int64_t delta_r = std::get<0>(color) - std::get<0>(frequent_color);
+        const int64_t delta_g = std::get<1>(color) - std::get<1>(frequent_color);
+        const int64_t delta_b = std::get<2>(color) - std::get<2>(frequent_color);
+        const int64_t distance = (delta_r * delta_r) + (delta_g * delta_g) + (delta_b * delta_b);
+
+        if (distance < min_distance) {
+            min_distance = distance;
+            closest_color = frequent_color;
         }
     }
 
     return closest_color;
 }
+
+template ColorHistogram::ColorHistogram(const InterleavedColors<int>& colors);
+template ColorHistogram::ColorHistogram(const InterleavedColors<uint8_t>& colors);
+template ColorHistogram::ColorHistogram(const InterleavedColors<uint16_t>& colors);
+template ColorHistogram::ColorHistogram(const PlanarColors<int>& colors);
+template ColorHistogram::ColorHistogram(const PlanarColors<uint8_t>& colors);
+template ColorHistogram::ColorHistogram(const PlanarColors<uint16_t>& colors);
+template ColorHistogram calculateColorFrequencies(const InterleavedColors<int>& colors);
+template ColorHistogram calculateColorFrequencies(const InterleavedColors<uint8_t>& colors);
+template ColorHistogram calculateColorFrequencies(const InterleavedColors<uint16_t>& colors);
+template ColorHistogram calculateColorFrequencies(const PlanarColors<int>& colors);
+template ColorHistogram calculateColorFrequencies(const PlanarColors<uint8_t>& colors);
+template ColorHistogram calculateColorFrequencies(const PlanarColors<uint16_t>& colors);
+template void replaceInfrequentColors(const InterleavedColors<int>& colors, const ColorHistogram& color_freq, int frequency_threshold);
+template void replaceInfrequentColors(const InterleavedColors<uint8_t>& colors, const ColorHistogram& color_freq, int frequency_threshold);
+template void replaceInfrequentColors(const InterleavedColors<uint16_t>& colors, const ColorHistogram& color_freq, int frequency_threshold);
+template void replaceInfrequentColors(const PlanarColors<int>& colors, const ColorHistogram& color_freq, int frequency_threshold);
+template void replaceInfrequentColors(const PlanarColors<uint8_t>& colors, const ColorHistogram& color_freq, int frequency_threshold);
+template void replaceInfrequentColors(const PlanarColors<uint16_t>& colors, const ColorHistogram& color_freq, int frequency_threshold);
+template void removeInfrequentColors(const InterleavedColors<int>& colors, int frequency_threshold);
+template void removeInfrequentColors(const InterleavedColors<uint8_t>& colors, int frequency_threshold);
+template void removeInfrequentColors(const InterleavedColors<uint16_t>& colors, int frequency_threshold);
+template void removeInfrequentColors(const PlanarColors<int>& colors, int frequency_threshold);
+template void removeInfrequentColors(const PlanarColors<uint8_t>& colors, int frequency_threshold);
+template void removeInfrequentColors(const PlanarColors<uint16_t>& colors, int frequency_threshold);
@@ -1,34 +1,260 @@
 #ifndef HELPERS_HPP
 #define HELPERS_HPP
 
-#include <map>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
 #include <tuple>
 #include <vector>
 
-// Struct to encapsulate R, G, and B channels
-struct ColorChannels {
-  std::vector<int> R;
-  std::vector<int> G;
-  std::vector<int> B;
+// Packs a color into a 48-bit key, 16 bits per channel. Keys sort in the same
+// order as (R, G, B) tuples.
+constexpr uint64_t packColor(int red, int green, int blue) {
+  constexpr int channel_bits = 16;
+  constexpr uint64_t channel_mask = 0xFFFF;
+  return ((static_cast<uint64_t>(red) & channel_mask) << (2 * channel_bits)) |
+         ((static_cast<uint64_t>(green) & channel_mask) << channel_bits) | (static_cast<uint64_t>(blue) & channel_mask);
+}
+
+constexpr std::tuple<int, int, int> unpackColor(uint64_t key) {
+  constexpr int channel_bits = 16;
+  constexpr uint64_t channel_mask = 0xFFFF;
+  return {static_cast<int>((key >> (2 * channel_bits)) & channel_mask), static_cast<int>((key >> channel_bits) & channel_mask),
+          static_cast<int>(key & channel_mask)};
+}
+
+// The color helpers below work in place on any image layout through a color
+// view: a cheap, copyable handle that reads and writes pixel i as a packed key
+template <typename Colors>
+concept ColorView = requires(const Colors colors, size_t pixel, uint64_t key) {
+  typename Colors::Channel;
+  { colors.size() } -> std::same_as<size_t>;
+  { colors.key(pixel) } -> std::same_as<uint64_t>;
+  colors.set(pixel, key);
 };
 
-// Helper function declarations
-std::map<std::tuple<int, int, int>, int> calculateColorFrequencies(
-    const ColorChannels& channels);
+// Pixels stored as interleaved r, g, b samples, as in AOS images
+template <typename ChannelType>
+struct InterleavedColors {
+  using Channel = ChannelType;
+  static constexpr size_t CHANNELS = 3;
+
+  std::span<Channel> samples;
 
-std::vector<std::tuple<int, int, int>> getInfrequentColors(
-    const std::map<std::tuple<int, int, int>, int>& color_freq,
-    int frequency_threshold);
+  [[nodiscard]] size_t size() const { return samples.size() / CHANNELS; }
+  [[nodiscard]] uint64_t key(size_t pixel) const {
+    return packColor(samples[CHANNELS * pixel], samples[(CHANNELS * pixel) + 1], samples[(CHANNELS * pixel) + 2]);
+  }
+  void set(size_t pixel, uint64_t key) const {
+    const auto [red, green, blue] = unpackColor(key);
+    samples[CHANNELS * pixel] = static_cast<Channel>(red);
+    samples[(CHANNELS * pixel) + 1] = static_cast<Channel>(green);
+    samples[(CHANNELS * pixel) + 2] = static_cast<Channel>(blue);
+  }
+};
 
-void replaceInfrequentColors(
-    ColorChannels& channels,
-    const std::map<std::tuple<int, int, int>, int>& color_freq,
-    int frequency_threshold);
+// Pixels stored as three equally long channel planes, as in SOA images
+template <typename ChannelType>
+struct PlanarColors {
+  using Channel = ChannelType;
 
-std::tuple<int, int, int> findClosestColor(
-    const std::tuple<int, int, int>& color,
-    const std::map<std::tuple<int, int, int>, int>& color_freq,
-    int frequency_threshold);
+  std::span<Channel> R;
+  std::span<Channel> G;
+  std::span<Channel> B;
 
-#endif // HELPERS_HPP
+  [[nodiscard]] size_t size() const { return R.size(); }
+  [[nodiscard]] uint64_t key(size_t pixel) const { return packColor(R[pixel], G[pixel], B[pixel]); }
+  void set(size_t pixel, uint64_t key) const {
+    const auto [red, green, blue] = unpackColor(key);
+    R[pixel] = static_cast<Channel>(red);
+    G[pixel] = static_cast<Channel>(green);
+    B[pixel] = static_cast<Channel>(blue);
+  }
+};
+
+// Flat open-addressing hash map from packed colors to values, using linear
+// probing and a load factor of at most one half
+template <typename Value>
+class PackedColorMap {
+public:
+  explicit PackedColorMap(size_t expected_size = 0) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * expected_size) {capacity *= 2;}
+    keys.assign(capacity, EMPTY_KEY);
+    values.assign(capacity, Value{});
+    shift = HASH_BITS - std::countr_zero(capacity);
+  }
+
+  // Inserts a value-initialized entry when the key is absent
+  Value& operator[](uint64_t key) {
+    size_t slot = slotOf(key);
+    if (keys[slot] != EMPTY_KEY) {return values[slot];}
+    if (2 * (used + 1) > keys.size()) {
+      grow();
+      slot = slotOf(key);
+    }
+    keys[slot] = key;
+    ++used;
+    return values[slot];
+  }
+
+  [[nodiscard]] const Value* find(uint64_t key) const {
+    const size_t slot = slotOf(key);
+    return keys[slot] == EMPTY_KEY ? nullptr : &values[slot];
+  }
+
+  [[nodiscard]] size_t size() const { return used; }
+
+  // Visits every (key, value) pair in unspecified order
+  template <typename Visitor>
+  void forEach(Visitor&& visit) const {
+    for (size_t slot = 0; slot < keys.size(); ++slot) {
+      if (keys[slot] != EMPTY_KEY) {visit(keys[slot], values[slot]);}
+    }
+  }
+
+private:
+  static constexpr size_t MIN_CAPACITY = 1024;
+  static constexpr uint64_t EMPTY_KEY = ~uint64_t{0};
+  static constexpr uint64_t HASH_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+  static constexpr int HASH_BITS = 64;
+
+  [[nodiscard]] size_t slotOf(uint64_t key) const {
+    const size_t mask = keys.size() - 1;
+    auto slot = static_cast<size_t>((key * HASH_MULTIPLIER) >> shift);
+    while (keys[slot] != key && keys[slot] != EMPTY_KEY) {slot = (slot + 1) & mask;}
+    return slot;
+  }
+
+  void grow() {
+    std::vector<uint64_t> old_keys = std::move(keys);
+    std::vector<Value> old_values = std::move(values);
+    keys.assign(old_keys.size() * 2, EMPTY_KEY);
+    values.assign(old_keys.size() * 2, Value{});
+    --shift;
+    for (size_t i = 0; i < old_keys.size(); ++i) {
+      if (old_keys[i] != EMPTY_KEY) {
+        const size_t slot = slotOf(old_keys[i]);
+        keys[slot] = old_keys[i];
+        values[slot] = std::move(old_values[i]);
+      }
+    }
+  }
+
+  std::vector<uint64_t> keys;
+  std::vector<Value> values;
+  int shift = 0;
+  size_t used = 0;
+};
+
+// Color frequency table. Uses a PackedColorMap keyed on the packed color, or
+// a dense 2^24 counter array for large 8-bit images.
+// Built for InterleavedColors and PlanarColors of int, uint8_t and uint16_t.
+class ColorHistogram {
+public:
+  template <ColorView Colors>
+  explicit ColorHistogram(const Colors& colors);
+
+  // Number of pixels with the given packed color (0 when absent)
+  [[nodiscard]] uint32_t count(uint64_t key) const;
+  // Number of distinct colors
+  [[nodiscard]] size_t size() const { return unique_colors; }
+  // Distinct packed colors whose count satisfies the predicate, in ascending key order
+  [[nodiscard]] std::vector<uint64_t> colors(bool frequent, int frequency_threshold) const;
+
+private:
+  template <ColorView Colors>
+  void buildDense(const Colors& colors);
+  template <ColorView Colors>
+  void buildHashed(const Colors& colors);
+
+  bool dense = false;
+  size_t unique_colors = 0;
+  std::vector<uint32_t> dense_counts;
+  PackedColorMap<uint32_t> hashed_counts;
+};
 
+// Nearest-color search over a fixed set of colors, backed by a k-d tree.
+// Distances are squared Euclidean distances in integer arithmetic; among
+// equally close colors the one with the smallest packed key wins, which
+// matches a linear scan over the colors in ascending key order.
+class NearestColorIndex {
+public:
+  explicit NearestColorIndex(std::span<const uint64_t> colors);
+
+  // Returns (0, 0, 0) when the index is empty
+  [[nodiscard]] std::tuple<int, int, int> nearest(const std::tuple<int, int, int>& color) const;
+
+private:
+  struct Node {
+    std::array<int, 3> rgb;
+    uint64_t key;
+    int axis;
+  };
+
+  struct Best {
+    int64_t distance;
+    uint64_t key;
+  };
+
+  void build(size_t first, size_t last);
+  void search(size_t first, size_t last, const std::array<int, 3>& target, Best& best) const;
+
+  std::vector<Node> nodes;  // Implicit tree: the node of [first, last) sits at its midpoint
+};
+
+// Number of worker threads used by the parallel helpers; 0 selects one per
+// hardware thread
+void setThreadCount(unsigned count);
+[[nodiscard]] unsigned threadCount();
+
+// Number of chunks parallelFor splits count items into
+[[nodiscard]] size_t parallelWorkers(size_t count);
+
+// Splits [0, count) into parallelWorkers(count) contiguous chunks and runs
+// body(first, last) on each through the shared thread pool. Small ranges run
+// on the calling thread.
+void parallelFor(size_t count, const std::function<void(size_t, size_t)>& body);
+
+// Same as parallelFor, also passing the chunk number for per-worker state
+void parallelForChunks(size_t count, const std::function<void(size_t, size_t, size_t)>& body);
+
+// Items per block so that a block touches about one core's share of cache,
+// while still leaving several blocks per worker to balance the load
+[[nodiscard]] size_t cacheBlockSize(size_t count, size_t bytes_per_item);
+
+// Runs body(first, last) on consecutive blocks of block_size items, handing
+// blocks out to the shared thread pool as workers become free
+void parallelForBlocks(size_t count, size_t block_size, const std::function<void(size_t, size_t)>& body);
+
+// Stable LSD radix sort, 8 bits per pass, of keys that fit in key_bits bits,
+// moving payload[i] along with keys[i]. Each pass histograms and scatters
+// contiguous chunks in parallel; passes whose digit is the same for every key
+// are skipped.
+void parallelRadixSort(std::vector<uint64_t>& keys, std::vector<uint32_t>& payload, unsigned key_bits);
+
+// The color helpers are instantiated for the same views as ColorHistogram
+template <ColorView Colors>
+ColorHistogram calculateColorFrequencies(const Colors& colors);
+
+// Maps every infrequent color to its closest frequent color. Each distinct
+// color is resolved once, in parallel over the colors.
+PackedColorMap<uint64_t> buildReplacementTable(const ColorHistogram& color_freq, int frequency_threshold);
+
+// Resolves the replacement table, then rewrites the pixels in a single pass
+template <ColorView Colors>
+void replaceInfrequentColors(const Colors& colors, const ColorHistogram& color_freq, int frequency_threshold);
+
+// cutfreq on any layout: replaces every color used by fewer than
+// frequency_threshold pixels with its closest frequent color, in place
+template <ColorView Colors>
+void removeInfrequentColors(const Colors& colors, int frequency_threshold);
+
+// frequent_colors holds packed keys in ascending order; ties resolve to the first
+std::tuple<int, int, int> findClosestColor(const std::tuple<int, int, int>& color, std::span<const uint64_t> frequent_colors);
+
+#endif // HELPERS_HPP
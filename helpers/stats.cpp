@@ -0,0 +1,72 @@
+#include "stats.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace {
+    struct TimerTotal {
+        uint64_t calls = 0;
+        std::chrono::nanoseconds elapsed{0};
+    };
+
+    // Recording happens per phase, not per pixel, so one lock is enough
+    std::mutex stats_mutex;
+    std::map<std::string, TimerTotal, std::less<>> timers;
+    std::map<std::string, uint64_t, std::less<>> counters;
+
+    template <typename Value>
+    Value& entry(std::map<std::string, Value, std::less<>>& totals, std::string_view name) {
+        auto found = totals.find(name);
+        if (found == totals.end()) {found = totals.emplace(std::string(name), Value{}).first;}
+        return found->second;
+    }
+}
+
+void setStatsEnabled(bool enabled) {
+    statsEnabledFlag.store(enabled, std::memory_order_relaxed);
+}
+
+void resetStats() {
+    const std::scoped_lock lock(stats_mutex);
+    timers.clear();
+    counters.clear();
+}
+
+void recordStatCounter(std::string_view name, uint64_t amount) {
+    const std::scoped_lock lock(stats_mutex);
+    entry(counters, name) += amount;
+}
+
+void recordStatMaximum(std::string_view name, uint64_t value) {
+    const std::scoped_lock lock(stats_mutex);
+    uint64_t& largest = entry(counters, name);
+    largest = std::max(largest, value);
+}
+
+void recordStatTimer(std::string_view name, std::chrono::nanoseconds elapsed) {
+    const std::scoped_lock lock(stats_mutex);
+    TimerTotal& total = entry(timers, name);
+    ++total.calls;
+    total.elapsed += elapsed;
+}
+
+std::string statsReport() {
+    const std::scoped_lock lock(stats_mutex);
+    std::ostringstream report;
+    report << R"({"timers": {)";
+    const char* separator = "";
+    for (const auto& [name, total] : timers) {
+        const std::chrono::duration<double, std::milli> milliseconds = total.elapsed;
+        report << separator << '"' << name << R"(": {"calls": )" << total.calls << R"(, "ms": )" << milliseconds.count() << "}";
+        separator = ", ";
+    }
+    report << R"(}, "counters": {)";
+    separator = "";
+    for (const auto& [name, value] : counters) {
+        report << separator << '"' << name << "\": " << value;
+        separator = ", ";
+    }
+    report << "}}";
+    return report.str();
+}
@@ -0,0 +1,58 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Opt-in timers and counters behind the --stats report. Nothing is recorded
+// until setStatsEnabled(true); until then a timer or counter costs a relaxed
+// load and a branch. Names are dotted with the phase first ("read.decode",
+// "cutfreq.infrequent_colors"); repeated names add up, also across threads.
+
+inline std::atomic<bool> statsEnabledFlag{false};
+
+[[nodiscard]] inline bool statsEnabled() { return statsEnabledFlag.load(std::memory_order_relaxed); }
+void setStatsEnabled(bool enabled);
+void resetStats();
+
+void recordStatCounter(std::string_view name, uint64_t amount);
+void recordStatMaximum(std::string_view name, uint64_t value);
+void recordStatTimer(std::string_view name, std::chrono::nanoseconds elapsed);
+
+inline void addStatCounter(std::string_view name, uint64_t amount) {
+  if (statsEnabled()) {recordStatCounter(name, amount);}
+}
+
+// For counters such as peaks, where the report shows the largest value seen
+inline void maxStatCounter(std::string_view name, uint64_t value) {
+  if (statsEnabled()) {recordStatMaximum(name, value);}
+}
+
+// Adds the time until it goes out of scope, and one call, to the named timer.
+// The name must outlive the timer.
+class ScopedTimer {
+public:
+  explicit ScopedTimer(std::string_view name)
+    : name(name), active(statsEnabled()), start(active ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+  ScopedTimer(ScopedTimer&&) = delete;
+  ScopedTimer& operator=(ScopedTimer&&) = delete;
+  ~ScopedTimer() {
+    if (active) {recordStatTimer(name, std::chrono::steady_clock::now() - start);}
+  }
+
+private:
+  std::string_view name;
+  bool active;
+  std::chrono::steady_clock::time_point start;
+};
+
+// {"timers": {name: {"calls": n, "ms": t}, ...}, "counters": {name: n, ...}}
+// on one line, names sorted
+[[nodiscard]] std::string statsReport();
+
+#endif // STATS_HPP
@@ -0,0 +1,98 @@
+#include "thread_pool.hpp"
+#include "helpers.hpp"
+#include <memory>
+#include <utility>
+
+namespace {
+    thread_local bool inside_pool_task = false;
+
+    std::mutex shared_pool_mutex;
+    std::unique_ptr<ThreadPool> shared_pool;
+
+    void runInline(const size_t count, const std::function<void(size_t)>& task) {
+        for (size_t i = 0; i < count; ++i) {task(i);}
+    }
+}
+
+ThreadPool::ThreadPool(const unsigned workers) {
+    threads.reserve(workers > 1 ? workers - 1 : 0);
+    for (unsigned worker = 1; worker < workers; ++worker) {
+        threads.emplace_back([this](const std::stop_token& stop) { workerLoop(stop); });
+    }
+}
+
+void ThreadPool::run(const size_t count, const std::function<void(size_t)>& task) {
+    if (inside_pool_task || threads.empty() || count <= 1) {
+        runInline(count, task);
+        return;
+    }
+    std::unique_lock<std::mutex> const batch(batch_mutex, std::try_to_lock);
+    if (!batch.owns_lock()) {
+        runInline(count, task);
+        return;
+    }
+    {
+        std::scoped_lock const lock(state_mutex);
+        batch_task = &task;
+        batch_count = count;
+        finished = 0;
+        next_index = 0;
+        ++generation;
+    }
+    wake.notify_all();
+    drain(task, count);
+    std::unique_lock<std::mutex> lock(state_mutex);
+    done.wait(lock, [this] { return finished == batch_count && active == 0; });
+    batch_task = nullptr;
+    if (failure) {std::rethrow_exception(std::exchange(failure, nullptr));}
+}
+
+void ThreadPool::workerLoop(const std::stop_token& stop) {
+    uint64_t seen = 0;
+    while (true) {
+        const std::function<void(size_t)>* task = nullptr;
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            if (!wake.wait(lock, stop, [this, seen] { return generation != seen; })) {return;}
+            seen = generation;
+            // A batch that already completed has cleared its task
+            if (batch_task == nullptr) {continue;}
+            task = batch_task;
+            count = batch_count;
+            ++active;
+        }
+        drain(*task, count);
+        std::scoped_lock const lock(state_mutex);
+        --active;
+        if (active == 0) {done.notify_all();}
+    }
+}
+
+void ThreadPool::drain(const std::function<void(size_t)>& task, const size_t count) {
+    size_t completed = 0;
+    inside_pool_task = true;
+    for (size_t i = next_index.fetch_add(1); i < count; i = next_index.fetch_add(1)) {
+        try {
+            task(i);
+        } catch (...) {
+            std::scoped_lock const lock(state_mutex);
+            if (!failure) {failure = std::current_exception();}
+        }
+        ++completed;
+    }
+    inside_pool_task = false;
+    std::scoped_lock const lock(state_mutex);
+    finished += completed;
+    if (finished == count) {done.notify_all();}
+}
+
+ThreadPool& sharedThreadPool() {
+    std::scoped_lock const lock(shared_pool_mutex);
+    const unsigned workers = threadCount();
+    if (!shared_pool || shared_pool->size() != workers) {
+        shared_pool.reset();
+        shared_pool = std::make_unique<ThreadPool>(workers);
+    }
+    return *shared_pool;
+}
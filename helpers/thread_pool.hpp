@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run batches of indexed tasks. The calling
+// thread works on its own batch too, and tasks are claimed one index at a
+// time, so uneven tasks still balance across the workers.
+// Only one batch runs at a time. A batch started while another is running,
+// or from inside a task, runs on the calling thread instead of waiting.
+class ThreadPool {
+public:
+  // Starts workers - 1 threads; the caller of run is the remaining worker
+  explicit ThreadPool(unsigned workers);
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+  ~ThreadPool() = default;
+
+  [[nodiscard]] unsigned size() const { return static_cast<unsigned>(threads.size()) + 1; }
+
+  // Runs task(i) for every i in [0, count) and returns once all have finished.
+  // The first exception thrown by a task is rethrown here.
+  void run(size_t count, const std::function<void(size_t)>& task);
+
+private:
+  void workerLoop(const std::stop_token& stop);
+  // Claims and runs task indices until none are left
+  void drain(const std::function<void(size_t)>& task, size_t count);
+
+  std::mutex batch_mutex;  // Held by the thread whose batch is running
+  std::mutex state_mutex;  // Guards the batch fields below
+  std::condition_variable_any wake;
+  std::condition_variable done;
+  const std::function<void(size_t)>* batch_task = nullptr;
+  size_t batch_count = 0;
+  size_t finished = 0;
+  unsigned active = 0;  // Workers currently inside drain
+  uint64_t generation = 0;
+  std::exception_ptr failure;
+  std::atomic<size_t> next_index{0};
+  std::vector<std::jthread> threads;  // Declared last so workers stop before the state they use is destroyed
+};
+
+// Pool shared by the parallel helpers, sized by threadCount(). It is rebuilt
+// on the next call after setThreadCount changes the count, so the count must
+// not change while parallel work is running.
+ThreadPool& sharedThreadPool();
+
+#endif // THREAD_POOL_HPP
@@ -1,54 +1,135 @@
 // imageaos.cpp
 
 #include "imageaos.hpp"
-#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <map>
+#include <span>
+#include <stdexcept>
 #include <vector>
+#include <common/resample.hpp>
 #include <helpers/helpers.hpp>
+#include <helpers/stats.hpp>
 
 // Constructor with width and height parameters
-ImageAOS::ImageAOS(const int width, const int height)
-    : pixels(static_cast<size_t>(width * height)), width(width), height(height) {}
+template <typename Channel>
+BasicImageAOS<Channel>::BasicImageAOS(const int width, const int height)
+    : pixels(static_cast<size_t>(width) * static_cast<size_t>(height)), width(width), height(height) {}
+
+template <typename Channel>
+std::span<typename BasicImageAOS<Channel>::Pixel> BasicImageAOS<Channel>::row(const int y) {
+    return std::span(pixels).subspan(static_cast<size_t>(y) * static_cast<size_t>(width), static_cast<size_t>(width));
+}
+
+template <typename Channel>
+std::span<const typename BasicImageAOS<Channel>::Pixel> BasicImageAOS<Channel>::row(const int y) const {
+    return std::span(pixels).subspan(static_cast<size_t>(y) * static_cast<size_t>(width), static_cast<size_t>(width));
+}
+
+// Both layouts are three packed samples per pixel, so the conversions copy
+// the whole pixel array at once
+template <typename Channel>
+BasicImageAOS<Channel> to_aos(const BasicImage<Channel>& image) {
+    static_assert(sizeof(typename BasicImageAOS<Channel>::Pixel) == sizeof(BasicPixel<Channel>), "Pixel layouts must match");
+    BasicImageAOS<Channel> converted(image.width, image.height);
+    std::memcpy(converted.pixels.data(), image.pixels.data(), image.pixels.size() * sizeof(BasicPixel<Channel>));
+    return converted;
+}
+
+template <typename Channel>
+BasicImage<Channel> from_aos(const BasicImageAOS<Channel>& image, const int max_color_value) {
+    BasicImage<Channel> converted{.width=image.width, .height=image.height, .max_color_value=max_color_value,
+                                  .pixels=std::vector<BasicPixel<Channel>>(image.pixels.size())};
+    std::memcpy(converted.pixels.data(), image.pixels.data(), image.pixels.size() * sizeof(BasicPixel<Channel>));
+    return converted;
+}
 
 // Main cutfreq function, which uses shared helper functions for color analysis
-void ImageAOS::cutfreq(const int frequency_threshold) {
-    // Extract Red, Green, and Blue channels from pixels
-    ColorChannels channels;
-    for (const auto&[R, G, B] : pixels) {
-        channels.R.push_back(R);
-        channels.G.push_back(G);
-        channels.B.push_back(B);
+template <typename Channel>
+void BasicImageAOS<Channel>::cutfreq(const int frequency_threshold) {
+    const ScopedTimer timer("cutfreq");
+    addStatCounter("cutfreq.pixels", pixels.size());
+    // The histogram and the remap read and write the pixel array in place
+    removeInfrequentColors(InterleavedColors<Channel>{.samples=pixel_samples(std::span(pixels))}, frequency_threshold);
+}
+namespace {
+
+    template <typename Channel>
+    void resize_nearest(const BasicImageAOS<Channel>& image, const ResizePlan& plan, BasicImageAOS<Channel>& resized_image) {
+        // Nearest-neighbor interpolation, source coordinates come from the plan
+        const std::vector<int32_t>& src_x = plan.columns().low;
+        const std::vector<int32_t>& src_y = plan.rows().low;
+        const auto source_width = static_cast<size_t>(image.width);
+        const auto output_width = static_cast<size_t>(resized_image.width);
+        // Output rows are independent, so blocks of rows are filled in parallel
+        const size_t block_rows = cacheBlockSize(src_y.size(), output_width * sizeof(typename BasicImageAOS<Channel>::Pixel));
+        parallelForBlocks(src_y.size(), block_rows, [&](size_t first_row, size_t last_row) {
+            for (size_t hgt = first_row; hgt < last_row; ++hgt) {
+                const size_t source_row = static_cast<size_t>(src_y[hgt]) * source_width;
+                for (size_t wdt = 0; wdt < output_width; ++wdt) {
+                    resized_image.pixels[(hgt * output_width) + wdt] = image.pixels[source_row + static_cast<size_t>(src_x[wdt])];
+                }
+            }
+        });
     }
-    auto color_freq = calculateColorFrequencies(channels);
-    auto infrequent_colors = getInfrequentColors(color_freq, frequency_threshold);
-    replaceInfrequentColors(channels, color_freq, frequency_threshold);
-    // Update the pixels with new color values
-    for (size_t i = 0; i < pixels.size(); ++i) {
-        pixels[i].R = channels.R[i];
-        pixels[i].G = channels.G[i];
-        pixels[i].B = channels.B[i];
+}
+
+template <typename Channel>
+BasicImageAOS<Channel> resize_aos(const BasicImageAOS<Channel>& image, const int new_width, const int new_height,
+                                  const ResizeMethod method) {
+    return resize_aos(image, *cached_resize_plan({.source_width=image.width, .source_height=image.height, .new_width=new_width,
+                                                  .new_height=new_height, .method=method}));
+}
+
+template <typename Channel>
+BasicImageAOS<Channel> resize_aos(const BasicImageAOS<Channel>& image, const ResizePlan& plan) {
+    if (plan.key().source_width != image.width || plan.key().source_height != image.height) {
+        throw std::runtime_error("Error: Resize plan does not match the image");
+    }
+    if (plan.key().method == ResizeMethod::bilinear) {throw std::runtime_error("Error: resize_aos has no bilinear filter");}
+    const ScopedTimer timer("resize");
+    BasicImageAOS<Channel> resized_image(plan.key().new_width, plan.key().new_height);
+    addStatCounter("resize.pixels", resized_image.pixels.size());
+    if (plan.key().method == ResizeMethod::nearest) {
+        resize_nearest(image, plan, resized_image);
+    } else {
+        resample_filtered(pixel_samples(std::span(image.pixels)), pixel_samples(std::span(resized_image.pixels)),
+                          PIXEL_CHANNELS, plan);
     }
+    return resized_image;
 }
-ImageAOS resize_aos(const ImageAOS& image, const int new_width, const int new_height) {
-    ImageAOS resized_image(new_width, new_height);
-
-    // Scaling factors for width and height
-    float const x_scale = static_cast<float>(image.width) / static_cast<float>(new_width);
-    float const y_scale = static_cast<float>(image.height) / static_cast<float>(new_height);
-
-    // Nearest-neighbor interpolation loop
-    for (int hgt = 0; hgt < new_height; ++hgt) {
-        for (int wdt = 0; wdt < new_width; ++wdt) {
-            // Calculate the nearest source coordinates in the original image
-            auto src_x = static_cast<size_t>(std::round(static_cast<float>(hgt) * x_scale));
-            auto src_y = static_cast<size_t>(std::round(static_cast<float>(wdt) * y_scale));
-            src_x = std::min(src_x, static_cast<size_t>(image.width - 1));
-            src_y = std::min(src_y, static_cast<size_t>(image.height - 1));
-
-            // Set the pixel in the resized image
-            resized_image.pixels[(static_cast<size_t>(hgt) * static_cast<size_t>(new_width)) + static_cast<size_t>(wdt)] =
-                image.pixels[(src_y * static_cast<size_t>(image.width)) + src_x];
+
+void resize_aos_streaming(PpmStripReader& reader, const std::string& output_path, const int new_width, const int new_height) {
+    const auto plan = cached_resize_plan({.source_width=reader.width(), .source_height=reader.height(),
+                                          .new_width=new_width, .new_height=new_height, .method=ResizeMethod::nearest});
+    const std::vector<int32_t>& src_x = plan->columns().low;
+    PpmStripWriter writer(output_path, new_width, new_height, reader.max_color_value());
+    std::vector<::Pixel> source_row(static_cast<size_t>(reader.width()));
+    std::vector<::Pixel> output_row(static_cast<size_t>(new_width));
+    size_t rows_read = 0;
+    for (const int32_t row : plan->rows().low) {
+        // Source rows are visited in order, so skipped rows are simply read over
+        while (rows_read <= static_cast<size_t>(row)) {
+            reader.read_rows(source_row);
+            ++rows_read;
         }
+        for (size_t wdt = 0; wdt < src_x.size(); ++wdt) {output_row[wdt] = source_row[static_cast<size_t>(src_x[wdt])];}
+        writer.write_rows(output_row);
     }
-    return resized_image;
+    writer.finish();
 }
+
+template class BasicImageAOS<int>;
+template class BasicImageAOS<uint8_t>;
+template class BasicImageAOS<uint16_t>;
+template BasicImageAOS<uint8_t> to_aos(const BasicImage<uint8_t>& image);
+template BasicImageAOS<uint16_t> to_aos(const BasicImage<uint16_t>& image);
+template BasicImage<uint8_t> from_aos(const BasicImageAOS<uint8_t>& image, int max_color_value);
+template BasicImage<uint16_t> from_aos(const BasicImageAOS<uint16_t>& image, int max_color_value);
+template BasicImageAOS<int> resize_aos(const BasicImageAOS<int>& image, int new_width, int new_height, ResizeMethod method);
+template BasicImageAOS<uint8_t> resize_aos(const BasicImageAOS<uint8_t>& image, int new_width, int new_height, ResizeMethod method);
+template BasicImageAOS<uint16_t> resize_aos(const BasicImageAOS<uint16_t>& image, int new_width, int new_height, ResizeMethod method);
+template BasicImageAOS<int> resize_aos(const BasicImageAOS<int>& image, const ResizePlan& plan);
+template BasicImageAOS<uint8_t> resize_aos(const BasicImageAOS<uint8_t>& image, const ResizePlan& plan);
+template BasicImageAOS<uint16_t> resize_aos(const BasicImageAOS<uint16_t>& image, const ResizePlan& plan);
@@ -3,29 +3,92 @@
 #ifndef IMAGEAOS_HPP
 #define IMAGEAOS_HPP
 
+#include <cstdint>
 #include <map>
+#include <span>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
+#include <common/binaryio.hpp>
+#include <common/image_layout.hpp>
+#include <common/resize_plan.hpp>
 #include <helpers/helpers.hpp>
 
-struct Pixel {
-    int R;
-    int G;
-    int B;
-};
-
-class ImageAOS {
+// Array-of-structures image, templated on the channel storage type.
+// Instantiated for int, uint8_t and uint16_t channels.
+template <typename Channel>
+class BasicImageAOS {
 public:
+    struct Pixel {
+        Channel R;
+        Channel G;
+        Channel B;
+    };
+
     std::vector<Pixel> pixels;
     int width;
     int height;
 
-    ImageAOS(int width, int height);
+    BasicImageAOS(int width, int height);
+
+    // The width pixels of row y
+    std::span<Pixel> row(int y);
+    [[nodiscard]] std::span<const Pixel> row(int y) const;
 
     void cutfreq(int frequency_threshold);
 };
-// Declare the resize function outside the class
-ImageAOS resize_aos(const ImageAOS& image, int new_width, int new_height);
 
-#endif // IMAGEAOS_HPP
+using ImageAOS = BasicImageAOS<int>;
+using ImageAOS8 = BasicImageAOS<uint8_t>;
+using ImageAOS16 = BasicImageAOS<uint16_t>;
+
+// Conversions from and to the interleaved image used by common/binaryio
+template <typename Channel>
+BasicImageAOS<Channel> to_aos(const BasicImage<Channel>& image);
+template <typename Channel>
+BasicImage<Channel> from_aos(const BasicImageAOS<Channel>& image, int max_color_value);
+
+// Declare the resize function outside the class; it uses a cached plan for these dimensions.
+// Nearest neighbor by default, or the area / Lanczos-3 filters (bilinear is SOA only).
+template <typename Channel>
+BasicImageAOS<Channel> resize_aos(const BasicImageAOS<Channel>& image, int new_width, int new_height,
+                                  ResizeMethod method = ResizeMethod::nearest);
+// Same with a caller-held plan whose source size matches the image
+template <typename Channel>
+BasicImageAOS<Channel> resize_aos(const BasicImageAOS<Channel>& image, const ResizePlan& plan);
 
+// Nearest-neighbor resize from a strip reader straight into output_path,
+// holding a single source row at a time
+void resize_aos_streaming(PpmStripReader& reader, const std::string& output_path, int new_width, int new_height);
+
+// Layout policy (common/image_layout.hpp) for array-of-structures images
+struct AosLayout {
+    template <typename Channel>
+    using image = BasicImageAOS<Channel>;
+
+    constexpr static std::string_view NAME = "aos";
+    constexpr static ResizeMethod DEFAULT_RESIZE = ResizeMethod::nearest;
+    constexpr static ResizeMethod STREAMING_RESIZE = ResizeMethod::nearest;
+
+    template <typename Channel>
+    static BasicImageAOS<Channel> from_interleaved(const BasicImage<Channel>& image) { return to_aos(image); }
+    template <typename Channel>
+    static BasicImage<Channel> to_interleaved(const BasicImageAOS<Channel>& image, const int max_color_value) {
+        return from_aos(image, max_color_value);
+    }
+    template <typename Channel>
+    static BasicImageAOS<Channel> resize(const BasicImageAOS<Channel>& image, const int new_width, const int new_height,
+                                         const ResizeMethod method) {
+        return resize_aos(image, new_width, new_height, method);
+    }
+    template <typename Channel>
+    static void cutfreq(BasicImageAOS<Channel>& image, const int frequency_threshold) { image.cutfreq(frequency_threshold); }
+    static void resize_streaming(PpmStripReader& reader, const std::string& output_path, const int new_width, const int new_height) {
+        resize_aos_streaming(reader, output_path, new_width, new_height);
+    }
+};
+
+static_assert(StreamingLayout<AosLayout>);
+
+#endif // IMAGEAOS_HPP
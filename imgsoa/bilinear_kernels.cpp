@@ -0,0 +1,144 @@
+#include "bilinear_kernels.hpp"
+#include <cstddef>
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+#endif
+
+constexpr static size_t AVX_I32_LANES = 8;
+constexpr static int FIXED_PRODUCT_BITS = 2 * RESIZE_FIXED_BITS;
+
+namespace {
+    // Interpolation weights of an axis in the accumulator's representation
+    template <typename Accumulator>
+    const std::vector<Accumulator>& axis_weights(const ResizeAxis& axis) {
+        if constexpr (std::is_same_v<Accumulator, int32_t>) {
+            return axis.fixed_weight;
+        } else {
+            return axis.weight;
+        }
+    }
+
+    int32_t blend_pair(const int32_t low, const int32_t high, const int32_t weight) {
+        return (low * (RESIZE_FIXED_ONE - weight)) + (high * weight);
+    }
+
+    float blend_pair(const float low, const float high, const float weight) {
+        return ((1.0F - weight) * low) + (weight * high);
+    }
+
+    // Rounds a horizontally blended value back to a channel sample, truncating
+    // like the per-pixel float formula
+    template <typename Channel>
+    Channel to_channel(const int32_t value) {return static_cast<Channel>(value >> FIXED_PRODUCT_BITS);}
+
+    template <typename Channel>
+    Channel to_channel(const float value) {return static_cast<Channel>(static_cast<int>(value));}
+
+#if defined(__AVX2__)
+    __m256i blend_lanes(const __m256i low, const __m256i high, const __m256i weight) {
+        const __m256i inverse = _mm256_sub_epi32(_mm256_set1_epi32(RESIZE_FIXED_ONE), weight);
+        return _mm256_add_epi32(_mm256_mullo_epi32(low, inverse), _mm256_mullo_epi32(high, weight));
+    }
+
+    __m256 blend_lanes(const __m256 low, const __m256 high, const __m256 weight) {
+        const __m256 inverse = _mm256_sub_ps(_mm256_set1_ps(1.0F), weight);
+        return _mm256_add_ps(_mm256_mul_ps(inverse, low), _mm256_mul_ps(weight, high));
+    }
+
+    // Widens 8 consecutive channel samples to 32-bit lanes
+    template <typename Channel>
+    __m256i load_lanes(std::span<const Channel> src) {
+        if constexpr (std::is_same_v<Channel, uint8_t>) {
+            return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src.data())));
+        } else if constexpr (std::is_same_v<Channel, uint16_t>) {
+            return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src.data())));
+        } else {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src.data()));
+        }
+    }
+
+    // Narrows 8 non-negative 32-bit lanes back to channel samples
+    template <typename Channel>
+    void store_lanes(const __m256i value, std::span<Channel> dst) {
+        if constexpr (std::is_same_v<Channel, int>) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst.data()), value);
+        } else {
+            const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+            if constexpr (std::is_same_v<Channel, uint16_t>) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst.data()), words);
+            } else {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst.data()), _mm_packus_epi16(words, words));
+            }
+        }
+    }
+
+    // Vertical blend of 8 source columns into the accumulator row
+    template <typename Channel, typename Accumulator>
+    void vertical_lanes(std::span<const Channel> low, std::span<const Channel> high, const Accumulator weight,
+                        std::span<Accumulator> out) {
+        const __m256i low_lanes = load_lanes(low);
+        const __m256i high_lanes = load_lanes(high);
+        if constexpr (std::is_same_v<Accumulator, int32_t>) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out.data()),
+                                blend_lanes(low_lanes, high_lanes, _mm256_set1_epi32(weight)));
+        } else {
+            _mm256_storeu_ps(out.data(), blend_lanes(_mm256_cvtepi32_ps(low_lanes), _mm256_cvtepi32_ps(high_lanes),
+                                                     _mm256_set1_ps(weight)));
+        }
+    }
+#endif
+
+    template <typename Channel, typename Accumulator>
+    void vertical_pass(std::span<const Channel> low, std::span<const Channel> high, const Accumulator weight,
+                       std::span<Accumulator> out) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + AVX_I32_LANES <= out.size(); i += AVX_I32_LANES) {
+            vertical_lanes(low.subspan(i), high.subspan(i), weight, out.subspan(i));
+        }
+#endif
+        for (; i < out.size(); ++i) {
+            out[i] = blend_pair(static_cast<Accumulator>(low[i]), static_cast<Accumulator>(high[i]), weight);
+        }
+    }
+}
+
+template <typename Channel>
+BilinearRowKernel<Channel>::BilinearRowKernel(const ResizePlan& resize_plan)
+    : plan(&resize_plan), vertical(static_cast<size_t>(resize_plan.key().source_width)) {}
+
+template <typename Channel>
+void BilinearRowKernel<Channel>::blend(std::span<const Channel> low, std::span<const Channel> high, const size_t new_row,
+                                       std::span<Channel> output) {
+    vertical_pass(low, high, axis_weights<Accumulator>(plan->rows())[new_row], std::span<Accumulator>(vertical));
+    const std::vector<int32_t>& column_low = plan->columns().low;
+    const std::vector<int32_t>& column_high = plan->columns().high;
+    const std::vector<Accumulator>& column_weight = axis_weights<Accumulator>(plan->columns());
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + AVX_I32_LANES <= output.size(); i += AVX_I32_LANES) {
+        const __m256i low_index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&column_low[i]));
+        const __m256i high_index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&column_high[i]));
+        if constexpr (std::is_same_v<Accumulator, int32_t>) {
+            const __m256i blended = blend_lanes(_mm256_i32gather_epi32(vertical.data(), low_index, sizeof(int32_t)),
+                                                _mm256_i32gather_epi32(vertical.data(), high_index, sizeof(int32_t)),
+                                                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&column_weight[i])));
+            store_lanes(_mm256_srli_epi32(blended, FIXED_PRODUCT_BITS), output.subspan(i));
+        } else {
+            const __m256 blended = blend_lanes(_mm256_i32gather_ps(vertical.data(), low_index, sizeof(float)),
+                                               _mm256_i32gather_ps(vertical.data(), high_index, sizeof(float)),
+                                               _mm256_loadu_ps(&column_weight[i]));
+            store_lanes(_mm256_cvttps_epi32(blended), output.subspan(i));
+        }
+    }
+#endif
+    for (; i < output.size(); ++i) {
+        output[i] = to_channel<Channel>(blend_pair(vertical[static_cast<size_t>(column_low[i])],
+                                                   vertical[static_cast<size_t>(column_high[i])], column_weight[i]));
+    }
+}
+
+template class BilinearRowKernel<int>;
+template class BilinearRowKernel<uint8_t>;
+template class BilinearRowKernel<uint16_t>;
@@ -0,0 +1,35 @@
+#ifndef BILINEAR_KERNELS_HPP
+#define BILINEAR_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include <common/resize_plan.hpp>
+
+// Separable bilinear interpolation of one channel row, with an AVX2 path
+// (8 samples per step, gathers for the column taps) and a scalar tail that
+// computes the same values. The two source rows are first blended vertically
+// across the whole source width, then every output sample is gathered from
+// that row through the column taps of a bilinear ResizePlan.
+// 8-bit channels use fixed point with RESIZE_FIXED_BITS-bit weights, which
+// cannot overflow 32-bit lanes; wider channels use single-precision float.
+// Results stay within one level of the per-pixel float formula.
+template <typename Channel>
+class BilinearRowKernel {
+  public:
+    using Accumulator = std::conditional_t<std::is_same_v<Channel, uint8_t>, int32_t, float>;
+
+    // The plan must outlive the kernel
+    explicit BilinearRowKernel(const ResizePlan& resize_plan);
+
+    // Writes output row new_row, interpolated between its source rows low and high
+    void blend(std::span<const Channel> low, std::span<const Channel> high, size_t new_row, std::span<Channel> output);
+
+  private:
+    const ResizePlan* plan;
+    std::vector<Accumulator> vertical;  // Source row after the vertical pass
+};
+
+#endif // BILINEAR_KERNELS_HPP
@@ -1,49 +1,247 @@
+
 #include "imagesoa.hpp"
+#include "bilinear_kernels.hpp"
+#include "common/maxlevel.hpp"
+#include "common/resample.hpp"
+#include "common/simd_kernels.hpp"
 #include "helpers/helpers.hpp" // Include the shared helper file
+#include "helpers/stats.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
 #include <map>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+constexpr static size_t CHANNEL_COUNT = 3;
+
 // Constructor with width and height parameters
-ImageSOA::ImageSOA(const int width, int const height)
-    : R(static_cast<size_t>(width * height)), G(static_cast<size_t>(width * height)),
-      B(static_cast<size_t>(width * height)), width(width), height(height) {}
+template <typename Channel>
+BasicImageSOA<Channel>::BasicImageSOA(const int width, int const height)
+    : R(static_cast<size_t>(width) * static_cast<size_t>(height)), G(static_cast<size_t>(width) * static_cast<size_t>(height)),
+      B(static_cast<size_t>(width) * static_cast<size_t>(height)), width(width), height(height) {}
+
+template <typename Channel>
+std::span<Channel> BasicImageSOA<Channel>::plane(const size_t channel) {
+    const std::array<std::vector<Channel>*, CHANNEL_COUNT> planes{&R, &G, &B};
+    return *planes.at(channel);
+}
+
+template <typename Channel>
+std::span<const Channel> BasicImageSOA<Channel>::plane(const size_t channel) const {
+    const std::array<const std::vector<Channel>*, CHANNEL_COUNT> planes{&R, &G, &B};
+    return *planes.at(channel);
+}
+
+template <typename Channel>
+std::span<Channel> BasicImageSOA<Channel>::row(const size_t channel, const int y) {
+    return plane(channel).subspan(static_cast<size_t>(y) * static_cast<size_t>(width), static_cast<size_t>(width));
+}
+
+template <typename Channel>
+std::span<const Channel> BasicImageSOA<Channel>::row(const size_t channel, const int y) const {
+    return plane(channel).subspan(static_cast<size_t>(y) * static_cast<size_t>(width), static_cast<size_t>(width));
+}
+
+// The planes are split from and joined into the interleaved samples by the
+// byte-shuffle kernels in common/simd_kernels
+template <typename Channel>
+BasicImageSOA<Channel> to_soa(const BasicImage<Channel>& image) {
+    BasicImageSOA<Channel> converted(image.width, image.height);
+    deinterleave_rgb(pixel_samples(std::span(image.pixels)), std::span(converted.R), std::span(converted.G), std::span(converted.B));
+    return converted;
+}
+
+template <typename Channel>
+BasicImage<Channel> from_soa(const BasicImageSOA<Channel>& image, const int max_color_value) {
+    BasicImage<Channel> converted{.width=image.width, .height=image.height, .max_color_value=max_color_value,
+                                  .pixels=std::vector<BasicPixel<Channel>>(image.R.size())};
+    interleave_rgb(std::span(image.R), std::span(image.G), std::span(image.B), pixel_samples(std::span(converted.pixels)));
+    return converted;
+}
 
 // Main cutfreq function, which uses shared helper functions for color analysis
-void ImageSOA::cutfreq(int frequency_threshold) {
-    // Create a ColorChannels instance to group R, G, and B channels
-    ColorChannels channels = {.R=R, .G=G, .B=B};
-
-    auto color_freq = calculateColorFrequencies(channels);
-    auto infrequent_colors = getInfrequentColors(color_freq, frequency_threshold);
-    replaceInfrequentColors(channels, color_freq, frequency_threshold);
-}
-
-    ImageSOA ImageSOA::resize_soa(const int new_width, const int new_height) const {
-    ImageSOA resized_image(new_width, new_height);
-    float const x_scale = static_cast<float>(width) / static_cast<float>(new_width);
-    float const y_scale = static_cast<float>(height) / static_cast<float>(new_height);
-    for (int hgt = 0; hgt < new_height; ++hgt) {
-        for (int wdt = 0; wdt < new_width; ++wdt) {
-            float const src_x = static_cast<float>(wdt) * x_scale;
-            float const src_y = static_cast<float>(hgt) * y_scale;
-            int const x_low = static_cast<int>(std::floor(src_x));
-            int const x_high = std::min(static_cast<int>(std::ceil(src_x)), width - 1);
-            int const y_low = static_cast<int>(std::floor(src_y));
-            int const y_high = std::min(static_cast<int>(std::ceil(src_y)), height - 1);
-            float const x_weight = src_x - static_cast<float>(x_low);
-            float const y_weight = src_y - static_cast<float>(y_low);
-            const auto idx_xl_yl = (static_cast<size_t>(y_low) * static_cast<size_t>(width)) + static_cast<size_t>(x_low);
-            const auto idx_xh_yl = (static_cast<size_t>(y_low) * static_cast<size_t>(width)) + static_cast<size_t>(x_high);
-            const auto idx_xl_yh = (static_cast<size_t>(y_high) * static_cast<size_t>(width)) + static_cast<size_t>(x_low);
-            const auto idx_xh_yh = (static_cast<size_t>(y_high) * static_cast<size_t>(width)) + static_cast<size_t>(x_high);
-            int const red_val = static_cast<int>(((1.0F - y_weight) * ((1.0F - x_weight) * static_cast<float>(R[idx_xl_yl]) + x_weight * static_cast<float>(R[idx_xh_yl]))) + (y_weight * ((1.0F - x_weight) * static_cast<float>(R[idx_xl_yh]) + x_weight * static_cast<float>(R[idx_xh_yh]))));
-            int const green_val = static_cast<int>(((1.0F - y_weight) * ((1.0F - x_weight) * static_cast<float>(G[idx_xl_yl]) + x_weight * static_cast<float>(G[idx_xh_yl]))) + (y_weight * ((1.0F - x_weight) * static_cast<float>(G[idx_xl_yh]) + x_weight * static_cast<float>(G[idx_xh_yh]))));
-            int const blue_val = static_cast<int>(((1.0F - y_weight) * ((1.0F - x_weight) * static_cast<float>(B[idx_xl_yl]) + x_weight * static_cast<float>(B[idx_xh_yl]))) + (y_weight * ((1.0F - x_weight) * static_cast<float>(B[idx_xl_yh]) + x_weight * static_cast<float>(B[idx_xh_yh]))));
-            resized_image.R[(static_cast<size_t>(hgt) * static_cast<size_t>(new_width)) + static_cast<size_t>(wdt)] = red_val;
-            resized_image.G[(static_cast<size_t>(hgt) * static_cast<size_t>(new_width)) + static_cast<size_t>(wdt)] = green_val;
-            resized_image.B[(static_cast<size_t>(hgt) * static_cast<size_t>(new_width)) + static_cast<size_t>(wdt)] = blue_val;
+template <typename Channel>
+void BasicImageSOA<Channel>::cutfreq(int frequency_threshold) {
+    const ScopedTimer timer("cutfreq");
+    addStatCounter("cutfreq.pixels", R.size());
+    // The histogram and the remap read and write the channel planes in place
+    removeInfrequentColors(PlanarColors<Channel>{.R=R, .G=G, .B=B}, frequency_threshold);
+}
+
+namespace {
+    // Neighboring source samples and interpolation weight for one destination coordinate
+    struct BilinearTap {
+        size_t low;
+        size_t high;
+        float weight;
+    };
+
+    std::vector<BilinearTap> bilinear_taps(const int source_size, const int new_size) {
+        float const scale = static_cast<float>(source_size) / static_cast<float>(new_size);
+        std::vector<BilinearTap> taps(static_cast<size_t>(new_size));
+        for (size_t i = 0; i < taps.size(); ++i) {
+            float const src = static_cast<float>(i) * scale;
+            int const low = static_cast<int>(std::floor(src));
+            int const high = std::min(static_cast<int>(std::ceil(src)), source_size - 1);
+            taps[i] = {.low=static_cast<size_t>(low), .high=static_cast<size_t>(high), .weight=src - static_cast<float>(low)};
         }
+        return taps;
     }
+
+    int blend(const std::array<int, 4>& corners, const float x_weight, const float y_weight) {
+        return static_cast<int>(((1.0F - y_weight) * ((1.0F - x_weight) * static_cast<float>(corners[0]) + x_weight * static_cast<float>(corners[1]))) + (y_weight * ((1.0F - x_weight) * static_cast<float>(corners[2]) + x_weight * static_cast<float>(corners[3]))));
+    }
+}
+
+template <typename Channel>
+BasicImageSOA<Channel> BasicImageSOA<Channel>::resize_soa(const int new_width, const int new_height,
+                                                          const ResizeMethod method) const {
+    return resize_soa(*cached_resize_plan({.source_width=width, .source_height=height, .new_width=new_width,
+                                           .new_height=new_height, .method=method}));
+}
+
+template <typename Channel>
+BasicImageSOA<Channel> BasicImageSOA<Channel>::resize_soa(const ResizePlan& plan) const {
+    if (plan.key().source_width != width || plan.key().source_height != height) {
+        throw std::runtime_error("Error: Resize plan does not match the image");
+    }
+    if (plan.key().method == ResizeMethod::nearest) {throw std::runtime_error("Error: resize_soa has no nearest-neighbor filter");}
+    const ScopedTimer timer("resize");
+    BasicImageSOA resized_image(plan.key().new_width, plan.key().new_height);
+    addStatCounter("resize.pixels", resized_image.R.size());
+    if (plan.key().method != ResizeMethod::bilinear) {
+        // Each plane is filtered on its own, all worker threads per plane
+        resample_filtered(std::span<const Channel>(R), std::span<Channel>(resized_image.R), 1, plan);
+        resample_filtered(std::span<const Channel>(G), std::span<Channel>(resized_image.G), 1, plan);
+        resample_filtered(std::span<const Channel>(B), std::span<Channel>(resized_image.B), 1, plan);
+        return resized_image;
+    }
+    const BilinearRowKernel<Channel> kernel(plan);
+    const ResizeAxis& rows = plan.rows();
+    const auto source_width = static_cast<size_t>(width);
+    const auto output_width = static_cast<size_t>(resized_image.width);
+    // Output rows are independent; each block of rows gets its own copy of the
+    // kernel's scratch row
+    const size_t block_rows = cacheBlockSize(rows.low.size(), CHANNEL_COUNT * output_width * sizeof(Channel));
+    parallelForBlocks(rows.low.size(), block_rows, [&](size_t first_row, size_t last_row) {
+        BilinearRowKernel<Channel> block_kernel = kernel;
+        for (size_t hgt = first_row; hgt < last_row; ++hgt) {
+            const auto resize_channel = [&](const std::vector<Channel>& source, std::vector<Channel>& output) {
+                const std::span<const Channel> channel(source);
+                block_kernel.blend(channel.subspan(static_cast<size_t>(rows.low[hgt]) * source_width, source_width),
+                                   channel.subspan(static_cast<size_t>(rows.high[hgt]) * source_width, source_width), hgt,
+                                   std::span(output).subspan(hgt * output_width, output_width));
+            };
+            resize_channel(R, resized_image.R);
+            resize_channel(G, resized_image.G);
+            resize_channel(B, resized_image.B);
+        }
+    });
     return resized_image;
 }
 
+template <typename Channel>
+BasicImageSOA<Channel> BasicImageSOA<Channel>::resize_soa_scalar(const int new_width, const int new_height) const {
+    BasicImageSOA resized_image(new_width, new_height);
+    std::vector<BilinearTap> const x_taps = bilinear_taps(width, new_width);
+    std::vector<BilinearTap> const y_taps = bilinear_taps(height, new_height);
+    for (size_t hgt = 0; hgt < y_taps.size(); ++hgt) {
+        const BilinearTap& y_tap = y_taps[hgt];
+        const size_t row_low = y_tap.low * static_cast<size_t>(width);
+        const size_t row_high = y_tap.high * static_cast<size_t>(width);
+        const size_t row_out = hgt * static_cast<size_t>(new_width);
+        for (size_t wdt = 0; wdt < x_taps.size(); ++wdt) {
+            const BilinearTap& x_tap = x_taps[wdt];
+            const auto blended = [&x_tap, &y_tap, row_low, row_high](const std::vector<Channel>& channel) {
+                return static_cast<Channel>(blend({channel[row_low + x_tap.low], channel[row_low + x_tap.high],
+                                                   channel[row_high + x_tap.low], channel[row_high + x_tap.high]},
+                                                  x_tap.weight, y_tap.weight));
+            };
+            resized_image.R[row_out + wdt] = blended(R);
+            resized_image.G[row_out + wdt] = blended(G);
+            resized_image.B[row_out + wdt] = blended(B);
+        }
+    }
+    return resized_image;
+}
+
+namespace {
+    // Splits a decoded row into the planes of a one-row image
+    template <typename Channel>
+    void store_row(std::span<const Pixel> row, BasicImageSOA<Channel>& planes) {
+        for (size_t i = 0; i < row.size(); ++i) {
+            planes.R[i] = static_cast<Channel>(row[i].r);
+            planes.G[i] = static_cast<Channel>(row[i].g);
+            planes.B[i] = static_cast<Channel>(row[i].b);
+        }
+    }
+
+    // Uses the row kernel of the in-memory resize at the same depth, so a
+    // streamed resize writes the same samples as read_ppm_native + resize_soa
+    template <typename Channel>
+    void stream_bilinear(PpmStripReader& reader, PpmStripWriter& writer, const ResizePlan& plan) {
+        // Ring of the two most recent source rows, one slot per row parity
+        std::array<BasicImageSOA<Channel>, 2> ring{BasicImageSOA<Channel>(reader.width(), 1), BasicImageSOA<Channel>(reader.width(), 1)};
+        std::vector<Pixel> source_row(static_cast<size_t>(reader.width()));
+        BilinearRowKernel<Channel> kernel(plan);
+        BasicImageSOA<Channel> output_row(plan.key().new_width, 1);
+        std::vector<Pixel> encoded_row(static_cast<size_t>(plan.key().new_width));
+        size_t rows_read = 0;
+        for (size_t hgt = 0; hgt < plan.rows().low.size(); ++hgt) {
+            const auto row_low = static_cast<size_t>(plan.rows().low[hgt]);
+            const auto row_high = static_cast<size_t>(plan.rows().high[hgt]);
+            for (; rows_read <= row_high; ++rows_read) {
+                reader.read_rows(source_row);
+                store_row<Channel>(source_row, ring.at(rows_read % 2));
+            }
+            kernel.blend(ring.at(row_low % 2).R, ring.at(row_high % 2).R, hgt, output_row.R);
+            kernel.blend(ring.at(row_low % 2).G, ring.at(row_high % 2).G, hgt, output_row.G);
+            kernel.blend(ring.at(row_low % 2).B, ring.at(row_high % 2).B, hgt, output_row.B);
+            for (size_t i = 0; i < encoded_row.size(); ++i) {
+                encoded_row[i] = {.r=output_row.R[i], .g=output_row.G[i], .b=output_row.B[i]};
+            }
+            writer.write_rows(encoded_row);
+        }
+    }
+}
+
+void resize_soa_streaming(PpmStripReader& reader, const std::string& output_path, const int new_width, const int new_height) {
+    const auto plan = cached_resize_plan({.source_width=reader.width(), .source_height=reader.height(),
+                                          .new_width=new_width, .new_height=new_height, .method=ResizeMethod::bilinear});
+    PpmStripWriter writer(output_path, new_width, new_height, reader.max_color_value());
+    if (reader.max_color_value() <= MAGICNUMB) {
+        stream_bilinear<uint8_t>(reader, writer, *plan);
+    } else {
+        stream_bilinear<uint16_t>(reader, writer, *plan);
+    }
+    writer.finish();
+}
+
+template <typename Target, typename Source>
+BasicImageSOA<Target> maxlevel_soa(const BasicImageSOA<Source>& image, const int max_color_value, const int new_max_color_value) {
+    const ScopedTimer timer("maxlevel");
+    addStatCounter("maxlevel.pixels", image.R.size());
+    const std::vector<uint16_t> table = build_maxlevel_table(max_color_value, new_max_color_value);
+    BasicImageSOA<Target> rescaled(image.width, image.height);
+    apply_maxlevel(table, std::span<const Source>(image.R), std::span<Target>(rescaled.R));
+    apply_maxlevel(table, std::span<const Source>(image.G), std::span<Target>(rescaled.G));
+    apply_maxlevel(table, std::span<const Source>(image.B), std::span<Target>(rescaled.B));
+    return rescaled;
+}
+
+template class BasicImageSOA<int>;
+template class BasicImageSOA<uint8_t>;
+template class BasicImageSOA<uint16_t>;
+template BasicImageSOA<uint8_t> to_soa(const BasicImage<uint8_t>& image);
+template BasicImageSOA<uint16_t> to_soa(const BasicImage<uint16_t>& image);
+template BasicImage<uint8_t> from_soa(const BasicImageSOA<uint8_t>& image, int max_color_value);
+template BasicImage<uint16_t> from_soa(const BasicImageSOA<uint16_t>& image, int max_color_value);
+template BasicImageSOA<uint8_t> maxlevel_soa(const BasicImageSOA<uint8_t>& image, int max_color_value, int new_max_color_value);
+template BasicImageSOA<uint16_t> maxlevel_soa(const BasicImageSOA<uint8_t>& image, int max_color_value, int new_max_color_value);
+template BasicImageSOA<uint8_t> maxlevel_soa(const BasicImageSOA<uint16_t>& image, int max_color_value, int new_max_color_value);
+template BasicImageSOA<uint16_t> maxlevel_soa(const BasicImageSOA<uint16_t>& image, int max_color_value, int new_max_color_value);
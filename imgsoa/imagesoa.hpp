@@ -3,25 +3,97 @@
 #ifndef IMAGESOA_HPP
 #define IMAGESOA_HPP
 
+#include <cstdint>
 #include <map>
+#include <span>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
+#include <common/binaryio.hpp>
+#include <common/image_layout.hpp>
+#include <common/resize_plan.hpp>
 
-class ImageSOA {
+// Structure-of-arrays image, templated on the channel storage type.
+// Instantiated for int, uint8_t and uint16_t channels.
+template <typename Channel>
+class BasicImageSOA {
 public:
-    std::vector<int> R;
-    std::vector<int> G;
-    std::vector<int> B;
+    std::vector<Channel> R;
+    std::vector<Channel> G;
+    std::vector<Channel> B;
     int width;
     int height;
 
   // Constructor to initialize the image dimensions
-  ImageSOA(int width, int height);
+  BasicImageSOA(int width, int height);
+
+    // Plane 0, 1 or 2 (R, G or B), and the width samples of row y of a plane
+    std::span<Channel> plane(size_t channel);
+    [[nodiscard]] std::span<const Channel> plane(size_t channel) const;
+    std::span<Channel> row(size_t channel, int y);
+    [[nodiscard]] std::span<const Channel> row(size_t channel, int y) const;
 
   // Function to remove infrequent colors
   void cutfreq(int frequency_threshold);
 
-    [[nodiscard]] ImageSOA resize_soa(int new_width, int new_height) const;
+    // Bilinear resize through the vectorized row kernels (bilinear_kernels.hpp),
+    // or the area / Lanczos-3 filters, using a cached plan for these dimensions
+    [[nodiscard]] BasicImageSOA resize_soa(int new_width, int new_height,
+                                           ResizeMethod method = ResizeMethod::bilinear) const;
+    // Same with a caller-held plan whose source size matches this image
+    [[nodiscard]] BasicImageSOA resize_soa(const ResizePlan& plan) const;
+    // Per-pixel float reference of the same interpolation
+    [[nodiscard]] BasicImageSOA resize_soa_scalar(int new_width, int new_height) const;
+};
+
+using ImageSOA = BasicImageSOA<int>;
+using ImageSOA8 = BasicImageSOA<uint8_t>;
+using ImageSOA16 = BasicImageSOA<uint16_t>;
+
+// Conversions from and to the interleaved image used by common/binaryio
+template <typename Channel>
+BasicImageSOA<Channel> to_soa(const BasicImage<Channel>& image);
+template <typename Channel>
+BasicImage<Channel> from_soa(const BasicImageSOA<Channel>& image, int max_color_value);
+
+// Rescales every channel plane from max_color_value to new_max_color_value
+// through the maxlevel lookup table (common/maxlevel.hpp). Instantiated for
+// 8 and 16-bit channels on both sides.
+template <typename Target, typename Source>
+BasicImageSOA<Target> maxlevel_soa(const BasicImageSOA<Source>& image, int max_color_value, int new_max_color_value);
+
+// Bilinear resize from a strip reader straight into output_path, keeping a
+// ring of the two source rows the current output row interpolates between
+void resize_soa_streaming(PpmStripReader& reader, const std::string& output_path, int new_width, int new_height);
+
+// Layout policy (common/image_layout.hpp) for structure-of-arrays images
+struct SoaLayout {
+    template <typename Channel>
+    using image = BasicImageSOA<Channel>;
+
+    constexpr static std::string_view NAME = "soa";
+    constexpr static ResizeMethod DEFAULT_RESIZE = ResizeMethod::bilinear;
+    constexpr static ResizeMethod STREAMING_RESIZE = ResizeMethod::bilinear;
+
+    template <typename Channel>
+    static BasicImageSOA<Channel> from_interleaved(const BasicImage<Channel>& image) { return to_soa(image); }
+    template <typename Channel>
+    static BasicImage<Channel> to_interleaved(const BasicImageSOA<Channel>& image, const int max_color_value) {
+        return from_soa(image, max_color_value);
+    }
+    template <typename Channel>
+    static BasicImageSOA<Channel> resize(const BasicImageSOA<Channel>& image, const int new_width, const int new_height,
+                                         const ResizeMethod method) {
+        return image.resize_soa(new_width, new_height, method);
+    }
+    template <typename Channel>
+    static void cutfreq(BasicImageSOA<Channel>& image, const int frequency_threshold) { image.cutfreq(frequency_threshold); }
+    static void resize_streaming(PpmStripReader& reader, const std::string& output_path, const int new_width, const int new_height) {
+        resize_soa_streaming(reader, output_path, new_width, new_height);
+    }
 };
 
+static_assert(StreamingLayout<SoaLayout>);
+
 #endif // IMAGESOA_HPP
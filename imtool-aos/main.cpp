@@ -1,3 +1,8 @@
-//
-// Created by Shriya Singh on 11/5/24.
-//
+// imtool-aos/main.cpp
+
+#include "common/pipeline.hpp"
+#include "imgaos/imageaos.hpp"
+
+int main(int argc, char* argv[]) {
+    return run_imtool<AosLayout>(argc, argv);
+}
@@ -1,3 +1,8 @@
-//
-// Created by Shriya Singh on 11/5/24.
-//
+// imtool-soa/main.cpp
+
+#include "common/pipeline.hpp"
+#include "imgsoa/imagesoa.hpp"
+
+int main(int argc, char* argv[]) {
+    return run_imtool<SoaLayout>(argc, argv);
+}
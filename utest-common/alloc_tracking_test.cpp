@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "common/binaryio.hpp"
+#include "common/compress.hpp"
+#include "helpers/alloc_tracking.hpp"
+#include "helpers/helpers.hpp"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+constexpr static size_t BLOCK_BYTES = 4096;
+constexpr static int TEST_SIDE = 64;
+constexpr static size_t TEST_PIXEL_BYTES = size_t{TEST_SIDE} * TEST_SIDE * 3;
+
+// Each test turns tracking on for itself only
+class AllocTrackingTest : public ::testing::Test {
+protected:
+    void SetUp() override { setAllocationTracking(true); }
+    void TearDown() override { setAllocationTracking(false); }
+};
+
+TEST_F(AllocTrackingTest, CountsAllocationsBytesAndPeak) {
+    const AllocationScope scope;
+    {
+        const auto first = std::make_unique<std::vector<char>>(BLOCK_BYTES);
+    }
+    const auto second = std::make_unique<std::vector<char>>(BLOCK_BYTES);
+    const AllocationTotals totals = scope.totals();
+    EXPECT_EQ(totals.allocations, 4U);  // Two vectors and their buffers
+    EXPECT_GE(totals.bytes, 2 * BLOCK_BYTES);
+    // The first buffer was freed before the second was made
+    EXPECT_GE(totals.peak_bytes, BLOCK_BYTES);
+    EXPECT_LT(totals.peak_bytes, 2 * BLOCK_BYTES);
+}
+
+// An inner scope measures its own peak without lowering the outer one
+TEST_F(AllocTrackingTest, NestedScopesKeepTheOuterPeak) {
+    const AllocationScope outer;
+    {
+        const std::vector<char> large(2 * BLOCK_BYTES);
+    }
+    {
+        const AllocationScope inner;
+        const std::vector<char> small(BLOCK_BYTES);
+        EXPECT_LT(inner.totals().peak_bytes, 2 * BLOCK_BYTES);
+    }
+    EXPECT_GE(outer.totals().peak_bytes, 2 * BLOCK_BYTES);
+}
+
+TEST_F(AllocTrackingTest, DisabledCountsNothing) {
+    setAllocationTracking(false);
+    const AllocationScope scope;
+    const std::vector<char> block(BLOCK_BYTES);
+    EXPECT_EQ(scope.totals().allocations, 0U);
+    EXPECT_EQ(scope.totals().bytes, 0U);
+}
+
+// Allocation budgets for the hot paths: decoding allocates the pixels and
+// little else, and compress needs its sort buffers but not per-pixel nodes.
+// Counts are process-wide, so the budget is taken on one thread.
+TEST_F(AllocTrackingTest, DecodeAndCompressStayWithinBudget) {
+    setThreadCount(1);
+    {
+        std::ofstream file("test_alloc_budget.ppm", std::ios::binary);
+        file << "P6\n" << TEST_SIDE << " " << TEST_SIDE << "\n255\n" << std::string(TEST_PIXEL_BYTES, '\x7f');
+    }
+    const AllocationScope decode;
+    const AnyImage image = read_ppm_native("test_alloc_budget.ppm");
+    EXPECT_LE(decode.totals().allocations, 4U);
+    EXPECT_LT(decode.totals().peak_bytes, TEST_PIXEL_BYTES + BLOCK_BYTES);
+
+    const AllocationScope compress;
+    const CompressedImage compressed = compress_image(std::get<Image8>(image));
+    EXPECT_LE(compress.totals().allocations, 16U);
+    EXPECT_LT(compress.totals().bytes, 16 * TEST_PIXEL_BYTES);
+    setThreadCount(0);
+    std::remove("test_alloc_budget.ppm");
+}
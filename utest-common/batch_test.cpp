@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "common/batch.hpp"
+#include "utest-common/test_support.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+constexpr static unsigned TEST_WORKERS = 3;
+constexpr static size_t JOB_COUNT = 8;
+
+TEST(BatchTest, ManifestSkipsBlankAndCommentLines) {
+    const std::string manifest = scratch_file("txt");
+    {
+        std::ofstream file(manifest);
+        file << "# nightly thumbnails\n"
+             << "a.ppm a_small.ppm resize 80 60\n"
+             << "\n"
+             << "  b.ppm b.cppm   maxlevel 255 + compress bits\n";
+    }
+    const std::vector<BatchJob> jobs = read_manifest(manifest);
+    ASSERT_EQ(jobs.size(), 2U);
+    EXPECT_EQ(jobs[0].line, 2U);
+    EXPECT_EQ(jobs[0].words, (std::vector<std::string>{"a.ppm", "a_small.ppm", "resize", "80", "60"}));
+    EXPECT_EQ(jobs[1].line, 4U);
+    EXPECT_EQ(jobs[1].words.size(), 7U);
+    EXPECT_THROW(read_manifest("missing_manifest.txt"), std::runtime_error);
+    std::remove(manifest.c_str());
+}
+
+// Every job runs once; bad lines and throwing jobs fail alone and are reported
+TEST(BatchTest, RunsEveryJobAndReportsFailures) {
+    std::vector<BatchJob> jobs;
+    for (size_t i = 0; i < JOB_COUNT; ++i) {
+        jobs.push_back({.line = i + 1, .words = {"in" + std::to_string(i) + ".ppm", "out" + std::to_string(i) + ".ppm", "cutfreq", "10"}});
+    }
+    jobs[2].words = {"in2.ppm", "out2.ppm", "cutfreq"};  // Missing the frequency
+    std::mutex outputs_mutex;
+    std::vector<std::string> outputs;
+    std::ostringstream status;
+    const size_t failures = run_batch(jobs, TEST_WORKERS, [&](const ProgArgs& job) {
+        if (job.getInputFile() == "in5.ppm") {throw std::runtime_error("Error: unreadable");}
+        const std::scoped_lock lock(outputs_mutex);
+        outputs.push_back(job.getOutputFile());
+    }, status);
+
+    EXPECT_EQ(failures, 2U);
+    EXPECT_EQ(outputs.size(), JOB_COUNT - 2);
+    const std::string report = status.str();
+    EXPECT_EQ(std::ranges::count(report, '\n'), static_cast<long>(JOB_COUNT));
+    EXPECT_NE(report.find("3: in2.ppm -> out2.ppm: FAILED Error: Invalid number of extra arguments for cutfreq."), std::string::npos);
+    EXPECT_NE(report.find("6: in5.ppm -> out5.ppm: FAILED Error: unreadable"), std::string::npos);
+    EXPECT_NE(report.find("1: in0.ppm -> out0.ppm: OK"), std::string::npos);
+}
@@ -0,0 +1,56 @@
+// compress_test.cpp
+#include "common/compress.hpp"
+#include "helpers/helpers.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+constexpr static int MAX_8BIT = 255;
+constexpr static int MAX_16BIT = 65535;
+constexpr static unsigned PARALLEL_THREADS = 4;
+constexpr static int OVERSIZED_SIDE = 65537;  // 65537^2 > 2^32 - 1 pixels
+
+TEST(CompressImageTest, SortedTableAndIndices) {
+    const Image8 image{.width=2, .height=2, .max_color_value=MAX_8BIT,
+                       .pixels={{.r=MAX_8BIT, .g=0, .b=0}, {.r=0, .g=0, .b=MAX_8BIT}, {.r=MAX_8BIT, .g=0, .b=0}, {.r=0, .g=1, .b=0}}};
+    const CompressedImage compressed = compress_image(image);
+
+    EXPECT_EQ(compressed.max_color, MAX_8BIT);
+    EXPECT_EQ(compressed.color_table, (std::vector<uint64_t>{0x0000FF, 0x000100, 0xFF0000}));
+    EXPECT_EQ(compressed.pixel_indices, (std::vector<uint32_t>{2, 0, 2, 1}));
+}
+
+// Many distinct 16-bit colors: the table must be sorted, unique, and the same
+// for every thread count
+TEST(CompressImageTest, WideColorsDeterministicAcrossThreadCounts) {
+    constexpr int side = 300;
+    Image16 image{.width=side, .height=side, .max_color_value=MAX_16BIT, .pixels={}};
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> channel(0, MAX_16BIT);
+    for (int i = 0; i < side * side; ++i) {
+        image.pixels.push_back({.r=static_cast<uint16_t>(channel(generator) % 64), .g=static_cast<uint16_t>(channel(generator)),
+                                .b=static_cast<uint16_t>(channel(generator) % 3)});
+    }
+    setThreadCount(1);
+    const CompressedImage serial = compress_image(image);
+    setThreadCount(PARALLEL_THREADS);
+    const CompressedImage parallel = compress_image(image);
+    setThreadCount(0);
+
+    EXPECT_EQ(parallel.color_table, serial.color_table);
+    EXPECT_EQ(parallel.pixel_indices, serial.pixel_indices);
+    EXPECT_TRUE(std::ranges::is_sorted(serial.color_table));
+    EXPECT_EQ(std::ranges::adjacent_find(serial.color_table), serial.color_table.end());
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        EXPECT_EQ(serial.color_table[serial.pixel_indices[i]],
+                  packColor(image.pixels[i].r, image.pixels[i].g, image.pixels[i].b));
+    }
+}
+
+// Positions and indices are 32-bit, so larger images are refused up front
+// instead of wrapping into a corrupt table
+TEST(CompressImageTest, RejectsMoreThan32BitPixelCounts) {
+    const Image8 image{.width=OVERSIZED_SIDE, .height=OVERSIZED_SIDE, .max_color_value=MAX_8BIT, .pixels={}};
+    EXPECT_THROW(static_cast<void>(compress_image(image)), std::runtime_error);
+}
@@ -0,0 +1,151 @@
+// histogram_test.cpp
+#include "helpers/helpers.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+constexpr static int MAX_8BIT = 255;
+constexpr static int MAX_16BIT = 65535;
+constexpr static uint32_t MAP_KEYS = 5000;  // Several times the map's minimum capacity
+constexpr static int KEY_SPREAD = 97;
+
+namespace {
+    // Distinct colors spread over all three channels, including 16-bit values
+    uint64_t mapKey(uint32_t i) {
+        return packColor(static_cast<int>(i % KEY_SPREAD), static_cast<int>((i / KEY_SPREAD) * 3),
+                         static_cast<int>((i * 13) % MAX_16BIT));
+    }
+}
+
+TEST(ColorHistogramTest, CountsPackedColors) {
+    std::vector<int> red = {MAX_8BIT, 0, 0, MAX_16BIT};
+    std::vector<int> green = {0, MAX_8BIT, MAX_8BIT, 1};
+    std::vector<int> blue = {0, 0, 0, MAX_16BIT};
+    const ColorHistogram histogram = calculateColorFrequencies(PlanarColors<int>{.R=red, .G=green, .B=blue});
+
+    EXPECT_EQ(histogram.size(), 3);
+    EXPECT_EQ(histogram.count(packColor(0, MAX_8BIT, 0)), 2);
+    EXPECT_EQ(histogram.count(packColor(MAX_16BIT, 1, MAX_16BIT)), 1);
+    EXPECT_EQ(histogram.count(packColor(1, 2, 3)), 0);
+}
+
+TEST(ColorHistogramTest, ColorsAreSortedLikeTuples) {
+    std::vector<uint8_t> samples;
+    for (int i = 0; i < 2000; ++i) {
+        samples.push_back(static_cast<uint8_t>(i % 7));
+        samples.push_back(static_cast<uint8_t>((i * 3) % 11));
+        samples.push_back(static_cast<uint8_t>(i % 5));
+    }
+    const ColorHistogram histogram = calculateColorFrequencies(InterleavedColors<uint8_t>{.samples=samples});
+    const std::vector<uint64_t> all_colors = histogram.colors(true, 1);
+
+    ASSERT_EQ(all_colors.size(), histogram.size());
+    for (size_t i = 1; i < all_colors.size(); ++i) {
+        EXPECT_LT(unpackColor(all_colors[i - 1]), unpackColor(all_colors[i]));
+    }
+}
+
+// The k-d tree must agree with the linear scan, including which color wins a tie
+TEST(NearestColorIndexTest, MatchesLinearScan) {
+    constexpr int COLOR_COUNT = 300;
+    constexpr int QUERY_COUNT = 2000;
+    constexpr int CHANNEL_RANGE = 12;
+    constexpr uint64_t LCG_MULTIPLIER = 6364136223846793005ULL;
+    constexpr uint64_t LCG_INCREMENT = 1442695040888963407ULL;
+    constexpr int LCG_SHIFT = 33;
+    uint64_t state = 1;
+    const auto next_channel = [&state]() {
+        state = (state * LCG_MULTIPLIER) + LCG_INCREMENT;
+        return static_cast<int>((state >> LCG_SHIFT) % CHANNEL_RANGE);
+    };
+    std::vector<uint64_t> colors;
+    for (int i = 0; i < COLOR_COUNT; ++i) {colors.push_back(packColor(next_channel(), next_channel(), next_channel()));}
+    std::ranges::sort(colors);
+    const auto duplicates = std::ranges::unique(colors);
+    colors.erase(duplicates.begin(), duplicates.end());
+
+    const NearestColorIndex index(colors);
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        const std::tuple<int, int, int> query{next_channel(), next_channel(), next_channel()};
+        EXPECT_EQ(index.nearest(query), findClosestColor(query, colors));
+    }
+}
+
+// Inserting far more keys than the initial capacity holds makes the map grow
+// several times; every entry must survive the rehash
+TEST(PackedColorMapTest, KeepsEntriesAcrossGrowth) {
+    PackedColorMap<uint32_t> map;
+    for (uint32_t i = 0; i < MAP_KEYS; ++i) {map[mapKey(i)] = i;}
+
+    EXPECT_EQ(map.size(), MAP_KEYS);
+    for (uint32_t i = 0; i < MAP_KEYS; ++i) {
+        const uint32_t* const value = map.find(mapKey(i));
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(*value, i);
+    }
+    map[mapKey(0)] += 1;  // Existing keys are updated, not added again
+    EXPECT_EQ(map.size(), MAP_KEYS);
+    EXPECT_EQ(*map.find(mapKey(0)), 1U);
+}
+
+TEST(PackedColorMapTest, FindMissesAbsentKeys) {
+    PackedColorMap<uint32_t> map;
+    EXPECT_EQ(map.find(packColor(0, 0, 0)), nullptr);
+    for (uint32_t i = 0; i < MAP_KEYS; i += 2) {map[mapKey(i)] = i;}
+
+    for (uint32_t i = 1; i < MAP_KEYS; i += 2) {EXPECT_EQ(map.find(mapKey(i)), nullptr);}
+    EXPECT_EQ(map.find(packColor(MAX_16BIT, MAX_16BIT, MAX_16BIT)), nullptr);
+    EXPECT_EQ(map.size(), MAP_KEYS / 2);
+}
+
+TEST(PackedColorMapTest, ForEachVisitsEveryEntryOnce) {
+    PackedColorMap<uint32_t> map(MAP_KEYS);
+    std::vector<uint64_t> expected;
+    for (uint32_t i = 0; i < MAP_KEYS; ++i) {
+        map[mapKey(i)] = i;
+        expected.push_back(mapKey(i));
+    }
+
+    std::vector<uint64_t> visited;
+    map.forEach([&visited](uint64_t key, uint32_t value) {
+        EXPECT_EQ(key, mapKey(value));
+        visited.push_back(key);
+    });
+    std::ranges::sort(visited);
+    std::ranges::sort(expected);
+    EXPECT_EQ(visited, expected);
+}
+
+// Every infrequent color maps to what the linear scan picks; frequent colors
+// have no entry
+TEST(ReplacementTableTest, MatchesLinearScan) {
+    constexpr int FREQUENCY_THRESHOLD = 3;
+    constexpr int FREQUENT_COLORS = 16;
+    constexpr int REPEATS = 5;
+    constexpr int RARE_COLORS = 500;
+    std::vector<uint16_t> samples;
+    const auto add_pixel = [&samples](int red, int green, int blue) {
+        samples.insert(samples.end(), {static_cast<uint16_t>(red), static_cast<uint16_t>(green), static_cast<uint16_t>(blue)});
+    };
+    for (int i = 0; i < FREQUENT_COLORS * REPEATS; ++i) {
+        add_pixel((i % FREQUENT_COLORS) * 4000, (i % 4) * 300, (i % FREQUENT_COLORS) * 11);
+    }
+    // Each rare color appears once
+    for (int i = 0; i < RARE_COLORS; ++i) {add_pixel((i * 131) % MAX_16BIT, (i * 7) % 1000, i % MAX_8BIT);}
+    const ColorHistogram histogram = calculateColorFrequencies(InterleavedColors<uint16_t>{.samples=samples});
+    const std::vector<uint64_t> frequent = histogram.colors(true, FREQUENCY_THRESHOLD);
+    const std::vector<uint64_t> infrequent = histogram.colors(false, FREQUENCY_THRESHOLD);
+    ASSERT_FALSE(frequent.empty());
+    ASSERT_FALSE(infrequent.empty());
+
+    const PackedColorMap<uint64_t> replacements = buildReplacementTable(histogram, FREQUENCY_THRESHOLD);
+    EXPECT_EQ(replacements.size(), infrequent.size());
+    for (const uint64_t color : infrequent) {
+        const uint64_t* const replacement = replacements.find(color);
+        ASSERT_NE(replacement, nullptr);
+        const auto [red, green, blue] = findClosestColor(unpackColor(color), frequent);
+        EXPECT_EQ(*replacement, packColor(red, green, blue));
+    }
+    for (const uint64_t color : frequent) {EXPECT_EQ(replacements.find(color), nullptr);}
+}
@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include "common/index_runs.hpp"
+#include <vector>
+
+constexpr static uint32_t LONG_RUN = 1000;
+constexpr static uint32_t WIDE_INDEX = 70000;
+
+TEST(IndexRunsTest, RoundTripsRunsOfEveryLength) {
+    std::vector<uint32_t> indices(LONG_RUN, WIDE_INDEX);
+    indices.insert(indices.end(), {0, 1, 1, 2, 2, 2});
+    std::vector<uint8_t> encoded;
+    append_index_runs(indices, encoded);
+    // 1000 equal indices need a two-byte length and a three-byte index
+    EXPECT_LT(encoded.size(), indices.size());
+
+    std::vector<uint32_t> decoded(indices.size());
+    decode_index_runs(encoded, decoded);
+    EXPECT_EQ(decoded, indices);
+}
+
+TEST(IndexRunsTest, RejectsRunsThatDoNotCoverTheOutput) {
+    const std::vector<uint32_t> indices = {3, 3, 3, 4};
+    std::vector<uint8_t> encoded;
+    append_index_runs(indices, encoded);
+
+    std::vector<uint32_t> too_short(indices.size() - 1);
+    EXPECT_THROW(decode_index_runs(encoded, too_short), std::runtime_error);
+    std::vector<uint32_t> too_long(indices.size() + 1);
+    EXPECT_THROW(decode_index_runs(encoded, too_long), std::runtime_error);
+    encoded.pop_back();
+    std::vector<uint32_t> exact(indices.size());
+    EXPECT_THROW(decode_index_runs(encoded, exact), std::runtime_error);
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "common/simd_kernels.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Covers the vector steps (16 and 8 pixels) and a scalar tail
+constexpr static size_t PIXELS = 77;
+constexpr static size_t RGB = 3;
+
+namespace {
+    template <typename Sample>
+    std::vector<Sample> numbered_samples() {
+        std::vector<Sample> samples(PIXELS * RGB);
+        for (size_t i = 0; i < samples.size(); ++i) {samples[i] = static_cast<Sample>((i * 257) + 1);}
+        return samples;
+    }
+
+    template <typename Sample>
+    void expect_round_trip() {
+        const std::vector<Sample> samples = numbered_samples<Sample>();
+        std::vector<Sample> red(PIXELS);
+        std::vector<Sample> green(PIXELS);
+        std::vector<Sample> blue(PIXELS);
+        deinterleave_rgb<Sample>(samples, red, green, blue);
+        for (size_t i = 0; i < PIXELS; ++i) {
+            ASSERT_EQ(red[i], samples[i * RGB]);
+            ASSERT_EQ(green[i], samples[(i * RGB) + 1]);
+            ASSERT_EQ(blue[i], samples[(i * RGB) + 2]);
+        }
+        std::vector<Sample> joined(samples.size());
+        interleave_rgb<Sample>(red, green, blue, joined);
+        EXPECT_EQ(joined, samples);
+    }
+}
+
+TEST(InterleaveTest, RoundTrips8BitSamples) {
+    expect_round_trip<uint8_t>();
+}
+
+TEST(InterleaveTest, RoundTrips16BitSamples) {
+    expect_round_trip<uint16_t>();
+}
+
+TEST(InterleaveTest, RoundTripsIntSamples) {
+    expect_round_trip<int>();
+}
@@ -0,0 +1,94 @@
+// maxlevel_test.cpp
+#include "common/binaryio.hpp"
+#include "common/maxlevel.hpp"
+#include "utest-common/test_support.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+constexpr static int MAX_8BIT = 255;
+constexpr static int MAX_16BIT = 65535;
+constexpr static int LOW_MAX = 100;
+constexpr static int WIDE_MAX = 1000;
+constexpr static int FUSED_WIDTH = 7;   // 21 samples: one vector of 8 lanes twice plus a tail
+constexpr static int FUSED_HEIGHT = 1;
+constexpr static uint16_t OVER_MAX = 4000;
+
+TEST(MaxlevelTest, TableRescalesAndClamps) {
+    const std::vector<uint16_t> table = build_maxlevel_table(LOW_MAX, MAX_8BIT);
+    ASSERT_EQ(table.size(), 256);
+    EXPECT_EQ(table[0], 0);
+    EXPECT_EQ(table[50], 127);
+    EXPECT_EQ(table[LOW_MAX], MAX_8BIT);
+    EXPECT_EQ(table[MAX_8BIT], MAX_8BIT);  // Out-of-range samples clamp to the old maximum
+}
+
+TEST(MaxlevelTest, StreamingWidensTo16Bit) {
+    const std::string input = scratch_file("in.ppm");
+    const std::string output = scratch_file("out.ppm");
+    std::ofstream file(input, std::ios::binary);
+    file << "P6\n2 3\n255\n";
+    const std::vector<uint8_t> pixel_data = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, MAX_8BIT};
+    file.write(reinterpret_cast<const char*>(pixel_data.data()), static_cast<std::streamsize>(pixel_data.size()));
+    file.close();
+
+    PpmStripReader reader(input);
+    maxlevel_streaming(reader, output, MAX_16BIT);
+
+    PpmStripReader result(output);
+    EXPECT_EQ(result.width(), 2);
+    EXPECT_EQ(result.height(), 3);
+    EXPECT_EQ(result.max_color_value(), MAX_16BIT);
+    std::vector<Pixel> rows(6);
+    ASSERT_EQ(result.read_rows(rows), 3);
+    EXPECT_EQ(rows[0].g, 257);
+    EXPECT_EQ(rows[5].b, MAX_16BIT);
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
+
+// The fused read must match the table for every sample, including samples
+// above the old maximum and the scalar tail of the vector loop
+TEST(MaxlevelTest, FusedReadNarrowsTo8Bit) {
+    const std::string file_path = scratch_file("ppm");
+    std::ofstream file(file_path, std::ios::binary);
+    file << "P6\n" << FUSED_WIDTH << " " << FUSED_HEIGHT << "\n" << WIDE_MAX << "\n";
+    std::vector<uint16_t> samples;
+    for (uint16_t i = 0; i < FUSED_WIDTH * FUSED_HEIGHT * 3; ++i) {samples.push_back(static_cast<uint16_t>(i * (WIDE_MAX / 20)));}
+    samples.back() = OVER_MAX;
+    for (const uint16_t sample : samples) {
+        file.put(static_cast<char>(sample >> 8U));
+        file.put(static_cast<char>(sample & 0xFFU));
+    }
+    file.close();
+
+    const AnyImage rescaled = read_ppm_maxlevel(file_path, MAX_8BIT);
+    ASSERT_TRUE(std::holds_alternative<Image8>(rescaled));
+    const Image8& image = std::get<Image8>(rescaled);
+    EXPECT_EQ(image.max_color_value, MAX_8BIT);
+    const std::vector<uint16_t> table = build_maxlevel_table(WIDE_MAX, MAX_8BIT);
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        EXPECT_EQ(image.pixels[i].r, table[samples[3 * i]]);
+        EXPECT_EQ(image.pixels[i].g, table[samples[(3 * i) + 1]]);
+        EXPECT_EQ(image.pixels[i].b, table[samples[(3 * i) + 2]]);
+    }
+    EXPECT_EQ(image.pixels.back().b, MAX_8BIT);
+    std::remove(file_path.c_str());
+}
+
+TEST(MaxlevelTest, InMemoryWidensTo16Bit) {
+    Image8 image{.width=FUSED_WIDTH, .height=FUSED_HEIGHT, .max_color_value=MAX_8BIT, .pixels={}};
+    for (uint8_t i = 0; i < FUSED_WIDTH; ++i) {
+        image.pixels.push_back({.r=i, .g=static_cast<uint8_t>(MAX_8BIT - i), .b=static_cast<uint8_t>(LOW_MAX + i)});
+    }
+    const Image16 rescaled = maxlevel_image<uint16_t>(image, MAX_16BIT);
+    EXPECT_EQ(rescaled.max_color_value, MAX_16BIT);
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        EXPECT_EQ(rescaled.pixels[i].r, image.pixels[i].r * 257);
+        EXPECT_EQ(rescaled.pixels[i].g, image.pixels[i].g * 257);
+        EXPECT_EQ(rescaled.pixels[i].b, image.pixels[i].b * 257);
+    }
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "common/binaryio.hpp"
+#include "common/maxlevel.hpp"
+#include "common/pipeline.hpp"
+#include "common/tiled_image.hpp"
+#include "helpers/stats.hpp"
+#include "utest-common/test_support.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <variant>
+#include <vector>
+
+constexpr static int SOURCE_WIDTH = 100;
+constexpr static int SOURCE_HEIGHT = 70;
+constexpr static int NEW_WIDTH = 50;
+constexpr static int NEW_HEIGHT = 40;
+constexpr static int NEW_MAX = 100;
+constexpr static size_t COLOR_STEP = 11;
+
+namespace {
+    Image8 numbered_image() {
+        Image8 image{.width=SOURCE_WIDTH, .height=SOURCE_HEIGHT, .max_color_value=MAGICNUMB,
+                     .pixels=std::vector<BasicPixel<uint8_t>>(static_cast<size_t>(SOURCE_WIDTH) * SOURCE_HEIGHT)};
+        for (size_t i = 0; i < image.pixels.size(); ++i) {
+            image.pixels[i] = {.r=static_cast<uint8_t>(i % COLOR_STEP), .g=static_cast<uint8_t>(i % 3), .b=static_cast<uint8_t>(i % 2)};
+        }
+        return image;
+    }
+
+    Image8 run_tiled(const Image8& image, const int frequency_threshold) {
+        TiledImage<uint8_t> tiled = to_tiled(image);
+        tiled.cutfreq(frequency_threshold);
+        return from_tiled(tiled, image.max_color_value);
+    }
+}
+
+class PipelineTest : public ::testing::Test {
+protected:
+    std::string input;
+    std::string output;
+
+    void SetUp() override {
+        input = scratch_file("in.ppm");
+        output = scratch_file("out.ppm");
+    }
+
+    void TearDown() override {
+        setStatsEnabled(false);
+        resetStats();
+        std::remove(input.c_str());
+        std::remove(output.c_str());
+    }
+};
+
+// Consecutive resize and cutfreq stages share one conversion to the layout;
+// maxlevel splits the stages into two such runs
+TEST_F(PipelineTest, ConvertsOncePerRunOfLayoutStages) {
+    const Image8 source = numbered_image();
+    write_ppm(input, source);
+    const std::array<const char*, 16> args = {"imtool", input.c_str(), output.c_str(), "--stats",
+                                              "resize", "50", "40", "+", "cutfreq", "2", "+", "maxlevel", "100",
+                                              "+", "cutfreq", "3"};
+    EXPECT_EQ(run_imtool<TiledLayout>(static_cast<int>(args.size()), args.data()), 0);
+    EXPECT_NE(statsReport().find(R"("layout.convert_in": {"calls": 2)"), std::string::npos);
+    EXPECT_NE(statsReport().find(R"("stage.cutfreq": {"calls": 2)"), std::string::npos);
+
+    const Image8 resized = from_tiled(resize_tiled(to_tiled(source), NEW_WIDTH, NEW_HEIGHT), MAGICNUMB);
+    const Image8 expected = run_tiled(maxlevel_image<uint8_t>(run_tiled(resized, 2), NEW_MAX), 3);
+    expect_same_pixels(std::get<Image8>(read_ppm_native(output)), expected);
+}
@@ -2,12 +2,14 @@
 #include <gtest/gtest.h>
 #include <array>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 // Test for "info" operation with valid arguments (exactly 3 arguments)
 TEST(ParseArgumentsTest, InfoOperationValid) {
     const std::array<const char*, 4> args = { "imtool", "photo.ppm", "out.ppm", "info" };
     EXPECT_NO_THROW({
-        const ProgArgs progArgs = ProgArgs::parse_arguments(3, args.data());
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
         EXPECT_EQ(progArgs.getOperation(), "info");
         EXPECT_EQ(progArgs.getInputFile(), "photo.ppm");
         EXPECT_EQ(progArgs.getOutputFile(), "out.ppm");
@@ -18,7 +20,7 @@ TEST(ParseArgumentsTest, InfoOperationValid) {
 TEST(ParseArgumentsTest, MaxlevelOperationValid) {
     const std::array<const char*, 5> args = { "imtool", "photo.ppm", "out.ppm", "maxlevel", "128" };
     EXPECT_NO_THROW({
-        const ProgArgs progArgs = ProgArgs::parse_arguments(4, args.data());
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
         EXPECT_EQ(progArgs.getOperation(), "maxlevel");
         EXPECT_EQ(progArgs.getAdditionalParams()[0], "128");
     });
@@ -28,18 +30,27 @@ TEST(ParseArgumentsTest, MaxlevelOperationValid) {
 TEST(ParseArgumentsTest, ResizeOperationValid) {
     const std::array<const char*, 6> args = { "imtool", "input.ppm", "output.ppm", "resize", "800", "600" };
     EXPECT_NO_THROW({
-        const ProgArgs progArgs = ProgArgs::parse_arguments(5, args.data());
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
         EXPECT_EQ(progArgs.getOperation(), "resize");
         EXPECT_EQ(progArgs.getAdditionalParams()[0], "800");
         EXPECT_EQ(progArgs.getAdditionalParams()[1], "600");
     });
 }
 
+// Test for "resize" with the optional filter argument
+TEST(ParseArgumentsTest, ResizeFilterValid) {
+    const std::array<const char*, 7> args = { "imtool", "input.ppm", "output.ppm", "resize", "800", "600", "lanczos3" };
+    EXPECT_NO_THROW({
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
+        EXPECT_EQ(progArgs.getAdditionalParams()[2], "lanczos3");
+    });
+}
+
 // Test for "cutfreq" operation with valid arguments (exactly 4 arguments)
 TEST(ParseArgumentsTest, CutfreqOperationValid) {
     const std::array<const char*, 5> args = { "imtool", "input.ppm", "output.ppm", "cutfreq", "10" };
     EXPECT_NO_THROW({
-        const ProgArgs progArgs = ProgArgs::parse_arguments(4, args.data());
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
         EXPECT_EQ(progArgs.getOperation(), "cutfreq");
         EXPECT_EQ(progArgs.getAdditionalParams()[0], "10");
     });
@@ -49,9 +60,93 @@ TEST(ParseArgumentsTest, CutfreqOperationValid) {
 TEST(ParseArgumentsTest, CompressOperationValid) {
     const std::array<const char*, 4> args = { "imtool", "input.ppm", "output.ppm", "compress" };
     EXPECT_NO_THROW({
-        const ProgArgs progArgs = ProgArgs::parse_arguments(3, args.data());
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
         EXPECT_EQ(progArgs.getOperation(), "compress");
     });
 }
 
+TEST(ParseArgumentsTest, CompressEncodingValid) {
+    const std::array<const char*, 5> args = { "imtool", "input.ppm", "output.cppm", "compress", "bits" };
+    EXPECT_NO_THROW({
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
+        EXPECT_EQ(progArgs.getAdditionalParams()[0], "bits");
+    });
+}
+
+// Stages separated by "+" keep their own parameters, in order
+TEST(ParseArgumentsTest, PipelineStagesValid) {
+    const std::array<const char*, 12> args = { "imtool", "in.ppm", "out.cppm", "resize", "80", "60", "+", "cutfreq", "10",
+                                               "+", "compress", "bits" };
+    EXPECT_NO_THROW({
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
+        ASSERT_EQ(progArgs.getOperations().size(), 3);
+        EXPECT_EQ(progArgs.getOperation(), "resize");
+        EXPECT_EQ(progArgs.getAdditionalParams(), (std::vector<std::string>{"80", "60"}));
+        EXPECT_EQ(progArgs.getOperations()[1].name, "cutfreq");
+        EXPECT_EQ(progArgs.getOperations()[2].params, std::vector<std::string>{"bits"});
+    });
+}
+
+TEST(ParseArgumentsTest, PipelineCompressMustBeLast) {
+    // Other tests leave pool threads running, which a forked child cannot shut down
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    const std::array<const char*, 8> args = { "imtool", "in.ppm", "out.ppm", "compress", "+", "cutfreq", "10", "+" };
+    EXPECT_EXIT(ProgArgs::parse_arguments(static_cast<int>(args.size()) - 1, args.data()), ::testing::ExitedWithCode(255), "compress must be the last");
+}
+
+// Test that "--threads N" is accepted anywhere and removed from the positional arguments
+TEST(ParseArgumentsTest, ThreadsOptionValid) {
+    const std::array<const char*, 7> args = { "imtool", "--threads", "8", "input.ppm", "output.ppm", "cutfreq", "10" };
+    EXPECT_NO_THROW({
+        const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
+        EXPECT_EQ(progArgs.getThreads(), 8);
+        EXPECT_EQ(progArgs.getInputFile(), "input.ppm");
+        EXPECT_EQ(progArgs.getOperation(), "cutfreq");
+        EXPECT_EQ(progArgs.getAdditionalParams()[0], "10");
+    });
+}
+
+// Test that "--batch manifest" replaces the positional arguments and "--jobs N" sets the workers
+TEST(ParseArgumentsTest, BatchOptionValid) {
+    const std::array<const char*, 5> args = { "imtool", "--batch", "jobs.txt", "--jobs", "4" };
+    const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
+    EXPECT_EQ(progArgs.getBatchManifest(), "jobs.txt");
+    EXPECT_EQ(progArgs.getJobs(), 4);
+    EXPECT_TRUE(progArgs.getOperations().empty());
+    EXPECT_THROW(static_cast<void>(progArgs.getOperation()), std::runtime_error);
+    EXPECT_THROW(static_cast<void>(progArgs.getAdditionalParams()), std::runtime_error);
+}
+
+// Concurrent batch jobs would share the process-wide heap counters
+TEST(ParseArgumentsTest, TrackAllocationsInBatchNeedsOneJob) {
+    // Earlier tests leave pool workers running, which a forked child cannot join at exit
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    const std::array<const char*, 6> args = { "imtool", "--batch", "jobs.txt", "--track-allocations", "--jobs", "2" };
+    EXPECT_EXIT(ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data()), ::testing::ExitedWithCode(255), "needs --jobs 1");
+    EXPECT_EXIT(ProgArgs::parse_arguments(static_cast<int>(args.size()) - 2, args.data()), ::testing::ExitedWithCode(255), "needs --jobs 1");
+    const std::array<const char*, 6> single = { "imtool", "--batch", "jobs.txt", "--track-allocations", "--jobs", "1" };
+    const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(single.size()), single.data());
+    EXPECT_TRUE(progArgs.getTrackAllocations());
+    EXPECT_EQ(progArgs.getJobs(), 1);
+}
+
+// Test that "--stats" is a flag and leaves the positional arguments alone
+TEST(ParseArgumentsTest, StatsOptionValid) {
+    const std::array<const char*, 6> args = { "imtool", "in.ppm", "out.ppm", "--stats", "maxlevel", "255" };
+    const ProgArgs progArgs = ProgArgs::parse_arguments(static_cast<int>(args.size()), args.data());
+    EXPECT_TRUE(progArgs.getStats());
+    EXPECT_EQ(progArgs.getOperation(), "maxlevel");
+    EXPECT_EQ(progArgs.getAdditionalParams(), (std::vector<std::string>{"255"}));
+}
+
+// Manifest lines throw instead of exiting so one bad line fails only its job
+TEST(ParseArgumentsTest, ParseJobThrowsOnInvalidLine) {
+    const std::vector<std::string> valid = { "in.ppm", "out.ppm", "resize", "80", "60", "+", "compress" };
+    const ProgArgs job = ProgArgs::parse_job(valid);
+    EXPECT_EQ(job.getOperations().size(), 2U);
+    EXPECT_EQ(job.getOutputFile(), "out.ppm");
+    EXPECT_THROW(ProgArgs::parse_job(std::vector<std::string>{ "in.ppm", "out.ppm" }), std::runtime_error);
+    EXPECT_THROW(ProgArgs::parse_job(std::vector<std::string>{ "in.ppm", "out.ppm", "cutfreq", "x" }), std::runtime_error);
+}
+
 // Edge cases can now use EXPECT_THROW with custom exception checking or test as needed
@@ -1,7 +1,10 @@
 #include <fstream>
 #include <gtest/gtest.h>
 #include "common/binaryio.hpp"       // Include the read_ppm function
+#include "utest-common/test_support.hpp"
+#include <cstdio>
 #include <string>
+#include <variant>
 
 constexpr static int MAGIC = 255;
 TEST(ReadPPMTest, ValidPPMFile) {
@@ -44,3 +47,73 @@ TEST(ReadPPMTest, InvalidMagicNumber) {
     std::string const file_path = "test_resources/resources/invalid_magic.ppm";
     EXPECT_THROW(read_ppm(file_path), std::runtime_error);
 }
+
+TEST(ReadPPMTest, ScalesLowMaxColorValue) {
+    const std::string file_path = scratch_file("ppm");
+    std::ofstream file(file_path, std::ios::binary);
+    file << "P6\n2 1\n15\n";
+    const std::vector<uint8_t> pixel_data = {15, 0, 5, 1, 10, 15};
+    file.write(reinterpret_cast<const char*>(pixel_data.data()), static_cast<std::streamsize>(pixel_data.size()));
+    file.close();
+
+    Image const image = read_ppm(file_path);
+
+    ASSERT_EQ(image.pixels.size(), 2);
+    EXPECT_EQ(image.max_color_value, 15);
+    EXPECT_EQ(image.pixels[0].r, 255); EXPECT_EQ(image.pixels[0].g, 0);   EXPECT_EQ(image.pixels[0].b, 85);
+    EXPECT_EQ(image.pixels[1].r, 17);  EXPECT_EQ(image.pixels[1].g, 170); EXPECT_EQ(image.pixels[1].b, 255);
+    std::remove(file_path.c_str());
+}
+
+TEST(ReadPPMTest, Decodes16BitBigEndian) {
+    const std::string file_path = scratch_file("ppm");
+    std::ofstream file(file_path, std::ios::binary);
+    file << "P6\n1 1\n65535\n";
+    const std::vector<uint8_t> pixel_data = {0xFF, 0xFF, 0x80, 0x00, 0x00, 0xFF};
+    file.write(reinterpret_cast<const char*>(pixel_data.data()), static_cast<std::streamsize>(pixel_data.size()));
+    file.close();
+
+    Image const image = read_ppm(file_path);
+
+    ASSERT_EQ(image.pixels.size(), 1);
+    EXPECT_EQ(image.pixels[0].r, 255);
+    EXPECT_EQ(image.pixels[0].g, 127);
+    EXPECT_EQ(image.pixels[0].b, 0);
+    std::remove(file_path.c_str());
+}
+
+TEST(ReadPPMTest, TruncatedRasterThrows) {
+    const std::string file_path = scratch_file("ppm");
+    std::ofstream file(file_path, std::ios::binary);
+    file << "P6\n2 2\n255\n";
+    const std::vector<uint8_t> pixel_data = {MAGIC, 0, 0, 0, MAGIC};
+    file.write(reinterpret_cast<const char*>(pixel_data.data()), static_cast<std::streamsize>(pixel_data.size()));
+    file.close();
+
+    EXPECT_THROW(read_ppm(file_path), std::runtime_error);
+    std::remove(file_path.c_str());
+}
+
+TEST(ReadPPMTest, NativeReaderPicksChannelDepth) {
+    const std::string narrow_path = scratch_file("narrow.ppm");
+    const std::string wide_path = scratch_file("wide.ppm");
+    std::ofstream narrow_file(narrow_path, std::ios::binary);
+    narrow_file << "P6\n1 1\n15\n";
+    narrow_file.put(1).put(7).put(15);
+    narrow_file.close();
+    std::ofstream wide_file(wide_path, std::ios::binary);
+    wide_file << "P6\n1 1\n65535\n";
+    const std::vector<uint8_t> pixel_data = {0xFF, 0xFF, 0x80, 0x00, 0x00, 0xFF};
+    wide_file.write(reinterpret_cast<const char*>(pixel_data.data()), static_cast<std::streamsize>(pixel_data.size()));
+    wide_file.close();
+
+    const AnyImage narrow = read_ppm_native(narrow_path);
+    ASSERT_TRUE(std::holds_alternative<Image8>(narrow));
+    EXPECT_EQ(std::get<Image8>(narrow).pixels[0].g, 7);
+    const AnyImage wide = read_ppm_native(wide_path);
+    ASSERT_TRUE(std::holds_alternative<Image16>(wide));
+    EXPECT_EQ(std::get<Image16>(wide).pixels[0].g, 0x8000);
+    EXPECT_EQ(std::get<Image16>(wide).pixels[0].b, 0x00FF);
+    std::remove(narrow_path.c_str());
+    std::remove(wide_path.c_str());
+}
@@ -0,0 +1,55 @@
+// resize_plan_test.cpp
+#include "common/resize_plan.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+constexpr static int SOURCE_SIDE = 4;
+constexpr static int NEW_SIDE = 8;
+constexpr static int PLAN_CACHE_CAPACITY = 8;
+
+TEST(ResizePlanTest, NearestAndBilinearTables) {
+    const ResizePlan nearest({.source_width=SOURCE_SIDE, .source_height=2, .new_width=NEW_SIDE, .new_height=1,
+                              .method=ResizeMethod::nearest});
+    EXPECT_EQ(nearest.columns().low, (std::vector<int32_t>{0, 1, 1, 2, 2, 3, 3, 3}));
+    EXPECT_EQ(nearest.rows().low, (std::vector<int32_t>{0}));
+
+    const ResizePlan bilinear({.source_width=SOURCE_SIDE, .source_height=SOURCE_SIDE, .new_width=NEW_SIDE,
+                               .new_height=NEW_SIDE, .method=ResizeMethod::bilinear});
+    EXPECT_EQ(bilinear.columns().low[3], 1);
+    EXPECT_EQ(bilinear.columns().high[3], 2);
+    EXPECT_FLOAT_EQ(bilinear.columns().weight[3], 0.5F);
+    EXPECT_EQ(bilinear.columns().fixed_weight[3], RESIZE_FIXED_ONE / 2);
+    // The last column clamps its upper neighbor to the image edge
+    EXPECT_EQ(bilinear.columns().high[NEW_SIDE - 1], SOURCE_SIDE - 1);
+}
+
+TEST(ResizePlanTest, CacheReusesPlansAndEvictsLeastRecent) {
+    const ResizePlanKey key{.source_width=SOURCE_SIDE, .source_height=SOURCE_SIDE, .new_width=NEW_SIDE,
+                            .new_height=NEW_SIDE, .method=ResizeMethod::bilinear};
+    const auto first = cached_resize_plan(key);
+    EXPECT_EQ(cached_resize_plan(key), first);
+    for (int side = 1; side <= PLAN_CACHE_CAPACITY; ++side) {
+        static_cast<void>(cached_resize_plan({.source_width=side, .source_height=side, .new_width=1, .new_height=1,
+                                              .method=ResizeMethod::nearest}));
+    }
+    EXPECT_NE(cached_resize_plan(key), first);
+}
+
+TEST(ResizePlanTest, RejectsEmptyDimensions) {
+    EXPECT_THROW(ResizePlan({.source_width=SOURCE_SIDE, .source_height=SOURCE_SIDE, .new_width=0, .new_height=NEW_SIDE,
+                             .method=ResizeMethod::nearest}), std::runtime_error);
+}
+
+TEST(ResizePlanTest, FilterWeightsSumToOne) {
+    for (const ResizeMethod method : {ResizeMethod::area, ResizeMethod::lanczos3}) {
+        const ResizePlan plan({.source_width=97, .source_height=5, .new_width=13, .new_height=41, .method=method});
+        for (const ResizeAxis* axis : {&plan.columns(), &plan.rows()}) {
+            for (size_t i = 0; i < axis->low.size(); ++i) {
+                int32_t total = 0;
+                for (size_t tap = 0; tap < axis->filter_taps; ++tap) {total += axis->filter_weight[(i * axis->filter_taps) + tap];}
+                EXPECT_EQ(total, FILTER_FIXED_ONE);
+            }
+        }
+    }
+}
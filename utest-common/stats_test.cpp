@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include "helpers/stats.hpp"
+#include <string>
+
+// Each test starts from an empty, disabled report and leaves it that way
+class StatsTest : public ::testing::Test {
+protected:
+    void SetUp() override { resetStats(); }
+    void TearDown() override {
+        setStatsEnabled(false);
+        resetStats();
+    }
+};
+
+TEST_F(StatsTest, DisabledRecordsNothing) {
+    addStatCounter("read.bytes", 10);
+    {
+        const ScopedTimer timer("read.decode");
+    }
+    EXPECT_EQ(statsReport(), R"({"timers": {}, "counters": {}})");
+}
+
+TEST_F(StatsTest, CountersAndTimersAddUp) {
+    setStatsEnabled(true);
+    addStatCounter("write.bytes", 3);
+    addStatCounter("write.bytes", 4);
+    addStatCounter("cutfreq.unique_colors", 1);
+    for (int i = 0; i < 2; ++i) {
+        const ScopedTimer timer("resize");
+    }
+    const std::string report = statsReport();
+    EXPECT_NE(report.find(R"("resize": {"calls": 2, "ms": )"), std::string::npos);
+    EXPECT_NE(report.find(R"("counters": {"cutfreq.unique_colors": 1, "write.bytes": 7})"), std::string::npos);
+}
+
+// A timer started before stats were enabled stays inactive
+TEST_F(StatsTest, TimerKeepsStateFromConstruction) {
+    {
+        const ScopedTimer timer("compress");
+        setStatsEnabled(true);
+    }
+    EXPECT_EQ(statsReport().find("compress"), std::string::npos);
+}
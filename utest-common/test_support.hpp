@@ -0,0 +1,45 @@
+#ifndef TEST_SUPPORT_HPP
+#define TEST_SUPPORT_HPP
+
+#include <gtest/gtest.h>
+#include "common/image_types.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Helpers shared by the utest-common, utest-imgaos and utest-imgsoa suites
+
+// Path of a scratch file in the temp directory, named after the running test.
+// ctest runs every test as its own process, so fixed names in the working
+// directory would be shared between tests running in parallel.
+inline std::string scratch_file(const std::string_view suffix) {
+    const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+    const std::string name = std::string(test->test_suite_name()) + "." + test->name() + "." + std::string(suffix);
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// 8-bit image whose neighboring pixels all differ
+inline Image8 gradient_image(const int width, const int height) {
+    Image8 image{.width=width, .height=height, .max_color_value=MAGICNUMB,
+                 .pixels=std::vector<BasicPixel<uint8_t>>(static_cast<size_t>(width) * static_cast<size_t>(height))};
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        image.pixels[i] = {.r=static_cast<uint8_t>(i * 37), .g=static_cast<uint8_t>(i * 91), .b=static_cast<uint8_t>(i * 13)};
+    }
+    return image;
+}
+
+template <typename Channel>
+void expect_same_pixels(const BasicImage<Channel>& output, const BasicImage<Channel>& expected) {
+    ASSERT_EQ(output.width, expected.width);
+    ASSERT_EQ(output.height, expected.height);
+    for (size_t i = 0; i < output.pixels.size(); ++i) {
+        ASSERT_EQ(output.pixels[i].r, expected.pixels[i].r);
+        ASSERT_EQ(output.pixels[i].g, expected.pixels[i].g);
+        ASSERT_EQ(output.pixels[i].b, expected.pixels[i].b);
+    }
+}
+
+#endif // TEST_SUPPORT_HPP
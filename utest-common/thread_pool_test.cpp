@@ -0,0 +1,41 @@
+// thread_pool_test.cpp
+#include "helpers/thread_pool.hpp"
+#include "helpers/helpers.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+constexpr static unsigned POOL_WORKERS = 4;
+constexpr static size_t TASK_COUNT = 1000;
+
+TEST(ThreadPoolTest, RunsEveryIndexOnce) {
+    ThreadPool pool(POOL_WORKERS);
+    std::vector<std::atomic<int>> runs(TASK_COUNT);
+    // Nested batches run on the worker that starts them
+    pool.run(TASK_COUNT, [&](size_t i) { pool.run(1, [&runs, i](size_t) { runs[i].fetch_add(1); }); });
+    pool.run(TASK_COUNT, [&runs](size_t i) { runs[i].fetch_add(1); });
+
+    for (const auto& count : runs) {EXPECT_EQ(count.load(), 2);}
+}
+
+TEST(ThreadPoolTest, RethrowsTaskException) {
+    ThreadPool pool(POOL_WORKERS);
+    EXPECT_THROW(pool.run(TASK_COUNT, [](size_t i) {
+        if (i == TASK_COUNT / 2) {throw std::runtime_error("task failed");}
+    }), std::runtime_error);
+    // The pool stays usable after a failed batch
+    std::atomic<size_t> total{0};
+    pool.run(TASK_COUNT, [&total](size_t i) { total += i; });
+    EXPECT_EQ(total.load(), TASK_COUNT * (TASK_COUNT - 1) / 2);
+}
+
+TEST(ThreadPoolTest, BlocksCoverRange) {
+    setThreadCount(POOL_WORKERS);
+    std::vector<int> covered(TASK_COUNT, 0);
+    parallelForBlocks(TASK_COUNT, cacheBlockSize(TASK_COUNT, sizeof(int)), [&covered](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {++covered[i];}
+    });
+    setThreadCount(0);
+    for (const int count : covered) {EXPECT_EQ(count, 1);}
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "common/resample.hpp"
+#include "common/tiled_image.hpp"
+#include "helpers/helpers.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+constexpr static int ODD_WIDTH = 150;   // Two full tiles and a 22-pixel edge tile
+constexpr static int ODD_HEIGHT = 70;   // One full band and a 6-row edge band
+constexpr static int NEW_WIDTH = 97;
+constexpr static int NEW_HEIGHT = 131;
+constexpr static int COLOR_STEP = 7;
+constexpr static size_t RARE_EVERY = 50;     // 7 rare colors of 30 pixels each
+constexpr static int CUTFREQ_THRESHOLD = 40;
+constexpr static uint16_t BRIGHT = 200;
+
+namespace {
+    // Every pixel differs from its neighbors, so misplaced copies show up
+    BasicImage<uint16_t> numbered_image(const int width, const int height) {
+        BasicImage<uint16_t> image{.width=width, .height=height, .max_color_value=MAGICNUMB,
+                                   .pixels=std::vector<BasicPixel<uint16_t>>(static_cast<size_t>(width) * static_cast<size_t>(height))};
+        for (size_t i = 0; i < image.pixels.size(); ++i) {
+            image.pixels[i] = {.r=static_cast<uint16_t>(i), .g=static_cast<uint16_t>(i >> 8U), .b=static_cast<uint16_t>(i % COLOR_STEP)};
+        }
+        return image;
+    }
+
+    bool same_pixels(const BasicImage<uint16_t>& first, const BasicImage<uint16_t>& second) {
+        for (size_t i = 0; i < first.pixels.size(); ++i) {
+            const auto& [r1, g1, b1] = first.pixels[i];
+            const auto& [r2, g2, b2] = second.pixels[i];
+            if (r1 != r2 || g1 != g2 || b1 != b2) {return false;}
+        }
+        return first.pixels.size() == second.pixels.size();
+    }
+}
+
+TEST(TiledImageTest, EdgeTilesAreCutToTheImage) {
+    const TiledImage<uint8_t> image(ODD_WIDTH, ODD_HEIGHT);
+    EXPECT_EQ(image.tiles_across(), 3);
+    EXPECT_EQ(image.tiles_down(), 2);
+    EXPECT_EQ(image.tile_width(2), ODD_WIDTH - (2 * TiledImage<uint8_t>::TILE_SIZE));
+    EXPECT_EQ(image.tile_height(1), ODD_HEIGHT - TiledImage<uint8_t>::TILE_SIZE);
+    EXPECT_EQ(image.pixels.size(), static_cast<size_t>(ODD_WIDTH) * ODD_HEIGHT);
+    // The last tile ends exactly at the end of the pixel array
+    const auto last = image.tile(2, 1);
+    EXPECT_EQ(last.data() + last.size(), image.pixels.data() + image.pixels.size());
+}
+
+TEST(TiledImageTest, RoundTripsThroughInterleaved) {
+    const BasicImage<uint16_t> image = numbered_image(ODD_WIDTH, ODD_HEIGHT);
+    const TiledImage<uint16_t> tiled = to_tiled(image);
+    EXPECT_EQ(tiled.at(ODD_WIDTH - 1, ODD_HEIGHT - 1).r, image.pixels.back().r);
+    EXPECT_EQ(tiled.row(1, 3).front().r, image.row(3)[TiledImage<uint16_t>::TILE_SIZE].r);
+    const BasicImage<uint16_t> back = from_tiled(tiled, image.max_color_value);
+    EXPECT_EQ(back.width, ODD_WIDTH);
+    EXPECT_EQ(back.height, ODD_HEIGHT);
+    EXPECT_TRUE(same_pixels(back, image));
+}
+
+TEST(TiledImageTest, NearestResizeMatchesThePlan) {
+    const BasicImage<uint16_t> image = numbered_image(ODD_WIDTH, ODD_HEIGHT);
+    const BasicImage<uint16_t> resized = from_tiled(resize_tiled(to_tiled(image), NEW_WIDTH, NEW_HEIGHT), MAGICNUMB);
+    const auto plan = cached_resize_plan({.source_width=ODD_WIDTH, .source_height=ODD_HEIGHT, .new_width=NEW_WIDTH,
+                                          .new_height=NEW_HEIGHT, .method=ResizeMethod::nearest});
+    for (int y = 0; y < NEW_HEIGHT; ++y) {
+        for (int x = 0; x < NEW_WIDTH; ++x) {
+            const auto source_row = image.row(plan->rows().low[static_cast<size_t>(y)]);
+            ASSERT_EQ(resized.row(y)[static_cast<size_t>(x)].r, source_row[static_cast<size_t>(plan->columns().low[static_cast<size_t>(x)])].r);
+        }
+    }
+}
+
+TEST(TiledImageTest, FilteredResizeMatchesInterleaved) {
+    const BasicImage<uint16_t> image = numbered_image(ODD_WIDTH, ODD_HEIGHT);
+    const auto plan = cached_resize_plan({.source_width=ODD_WIDTH, .source_height=ODD_HEIGHT, .new_width=NEW_WIDTH,
+                                          .new_height=NEW_HEIGHT, .method=ResizeMethod::lanczos3});
+    BasicImage<uint16_t> expected{.width=NEW_WIDTH, .height=NEW_HEIGHT, .max_color_value=MAGICNUMB,
+                                  .pixels=std::vector<BasicPixel<uint16_t>>(static_cast<size_t>(NEW_WIDTH) * NEW_HEIGHT)};
+    resample_filtered(pixel_samples(std::span(image.pixels)), pixel_samples(std::span(expected.pixels)), PIXEL_CHANNELS, *plan);
+    const auto resized = TiledLayout::resize(to_tiled(image), NEW_WIDTH, NEW_HEIGHT, ResizeMethod::lanczos3);
+    EXPECT_TRUE(same_pixels(from_tiled(resized, MAGICNUMB), expected));
+    EXPECT_THROW(static_cast<void>(resize_tiled(to_tiled(image), NEW_WIDTH, NEW_HEIGHT, ResizeMethod::bilinear)), std::runtime_error);
+}
+
+TEST(TiledImageTest, CutfreqMatchesInterleaved) {
+    BasicImage<uint16_t> image = numbered_image(ODD_WIDTH, ODD_HEIGHT);
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        const auto shade = static_cast<uint16_t>(i % 2 == 0 ? 0 : BRIGHT);
+        image.pixels[i] = i % RARE_EVERY == 0 ? BasicPixel<uint16_t>{.r=static_cast<uint16_t>(i % COLOR_STEP), .g=static_cast<uint16_t>(i % 5), .b=1}
+                                              : BasicPixel<uint16_t>{.r=shade, .g=shade, .b=shade};
+    }
+    TiledImage<uint16_t> tiled = to_tiled(image);
+    TiledLayout::cutfreq(tiled, CUTFREQ_THRESHOLD);
+    removeInfrequentColors(InterleavedColors<uint16_t>{.samples=pixel_samples(std::span(image.pixels))}, CUTFREQ_THRESHOLD);
+    EXPECT_EQ(image.pixels.front().b, 0);  // The rare colors are gone
+    EXPECT_TRUE(same_pixels(from_tiled(tiled, MAGICNUMB), image));
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "common/binaryio.hpp"       // Include the read_ppm function
+#include <algorithm>
+#include <filesystem>
+#include <numeric>
 
 // Define shorter constants for readability and to avoid magic numbers
 constexpr static int MAX_COLOR_LARGE = 65535;
@@ -21,6 +24,18 @@ constexpr static int RED = 0xFF0000;
 constexpr static int GREEN = 0x00FF00;
 constexpr static int BLUE = 0x0000FF;
 constexpr static int YELLOW = 0xFFFF00;
+constexpr static int WIDTH_STRIP = 67;
+constexpr static int HEIGHT_STRIP = 3;
+constexpr static uint32_t TABLE_STRIP = 70000;
+constexpr static uint32_t INDEX_STEP = 7919;
+constexpr static std::streamoff TRUNCATED_BYTES = 3;
+constexpr static int WIDTH_PACKED = 97;
+constexpr static int HEIGHT_PACKED = 5;
+constexpr static uint32_t MAX_PACKED_TABLE = 1U << 18U;
+constexpr static int WIDTH_RUNS = 45;
+constexpr static int HEIGHT_RUNS = 150;  // Three blocks, the last one partial
+constexpr static uint32_t RUN_COLORS = 5;
+constexpr static uint32_t RUN_LENGTH = 37;
 namespace {
     void validate_cppm_file(const std::string& file_path, const CompressedImage& expected_image) {
         CompressedImage read_image = read_cppm(file_path);
@@ -96,3 +111,107 @@ TEST(WriteCPPMTest, SmallImageWith2ByteIndices) {
     write_cppm(file_path, image);
     validate_cppm_file(file_path, image);
 }
+
+// Enough pixels for every index width to run both the vector loops and the scalar tail
+TEST(WriteCPPMTest, IndexWidthsRoundTrip) {
+    for (const uint32_t table_size : {uint32_t{MAGIC}, uint32_t{NUMCOLORS}, TABLE_STRIP}) {
+        CompressedImage image;
+        image.width = WIDTH_STRIP;
+        image.height = HEIGHT_STRIP;
+        image.max_color = MAX_COLOR_LARGE;
+        for (uint32_t i = 0; i < table_size; ++i) {image.color_table.push_back(uint64_t{i} * COLOR_MULT_LARGE);}
+        for (uint32_t i = 0; i < WIDTH_STRIP * HEIGHT_STRIP; ++i) {image.pixel_indices.push_back((i * INDEX_STEP) % table_size);}
+
+        const std::string file_path = "test_index_widths.cppm";
+        write_cppm(file_path, image);
+        validate_cppm_file(file_path, image);
+    }
+}
+
+TEST(WriteCPPMTest, TruncatedFileIsRejected) {
+    CompressedImage image;
+    image.width = WIDTH_SMALL;
+    image.height = HEIGHT_SMALL;
+    image.max_color = MAGIC;
+    image.color_table = { RED, GREEN, BLUE, YELLOW };
+    image.pixel_indices = { 0, 1, 2, 3 };
+
+    const std::string file_path = "test_truncated.cppm";
+    write_cppm(file_path, image);
+    std::filesystem::resize_file(file_path, std::filesystem::file_size(file_path) - TRUNCATED_BYTES);
+    EXPECT_THROW(read_cppm(file_path), std::runtime_error);
+}
+
+TEST(CompressedImageViewTest, DecodesRowsAtStoredWidth) {
+    CompressedImage image;
+    image.width = WIDTH_SMALL;
+    image.height = HEIGHT_SMALL;
+    image.max_color = MAGIC;
+    image.color_table = { RED, GREEN, BLUE };
+    image.pixel_indices = { 2, 0, 2, 1 };
+
+    const std::string file_path = "test_view.cppm";
+    write_cppm(file_path, image);
+    const CompressedImageView view(file_path);
+    EXPECT_EQ(view.width(), WIDTH_SMALL);
+    EXPECT_EQ(view.height(), HEIGHT_SMALL);
+    EXPECT_EQ(view.max_color(), MAGIC);
+    ASSERT_EQ(view.color_count(), image.color_table.size());
+    EXPECT_EQ(view.color(2), uint64_t{BLUE});
+    EXPECT_EQ(view.index_bits(), 8U);
+    EXPECT_EQ(view.index_bytes().size(), image.pixel_indices.size());
+
+    std::vector<uint32_t> row(WIDTH_SMALL);
+    view.decode_row(1, row);
+    EXPECT_EQ(row, (std::vector<uint32_t>{2, 1}));
+    EXPECT_EQ(view.index(1), 0U);
+    EXPECT_EQ(view.palette_histogram(), (std::vector<size_t>{1, 1, 2}));
+    EXPECT_THROW(view.decode_row(HEIGHT_SMALL, row), std::runtime_error);
+}
+
+// Palette sizes around every bit width up to 18 bits, with rows that do not end on byte boundaries
+TEST(WriteCPPMTest, BitPackedRoundTrip) {
+    for (uint32_t table_size = 2; table_size <= MAX_PACKED_TABLE; table_size *= 2) {
+        for (const uint32_t size : {table_size - 1, table_size, table_size + 1}) {
+            CompressedImage image;
+            image.width = WIDTH_PACKED;
+            image.height = HEIGHT_PACKED;
+            image.max_color = MAGIC;
+            for (uint32_t i = 0; i < size; ++i) {image.color_table.push_back(i);}
+            for (uint32_t i = 0; i < WIDTH_PACKED * HEIGHT_PACKED; ++i) {image.pixel_indices.push_back((i * INDEX_STEP) % size);}
+
+            const std::string file_path = "test_bit_packed.cppm";
+            write_cppm(file_path, image, CppmIndexEncoding::bits);
+            validate_cppm_file(file_path, image);
+            const CompressedImageView view(file_path);
+            std::vector<uint32_t> row(WIDTH_PACKED);
+            view.decode_row(HEIGHT_PACKED - 1, row);
+            EXPECT_EQ(row.back(), image.pixel_indices.back());
+        }
+    }
+}
+
+TEST(WriteCPPMTest, RunLengthBlocksRoundTrip) {
+    CompressedImage image;
+    image.width = WIDTH_RUNS;
+    image.height = HEIGHT_RUNS;
+    image.max_color = MAX_COLOR_LARGE;
+    for (uint32_t i = 0; i < RUN_COLORS; ++i) {image.color_table.push_back(uint64_t{i} * COLOR_MULT_LARGE);}
+    for (uint32_t i = 0; i < WIDTH_RUNS * HEIGHT_RUNS; ++i) {image.pixel_indices.push_back((i / RUN_LENGTH) % RUN_COLORS);}
+
+    const std::string file_path = "test_run_blocks.cppm";
+    write_cppm(file_path, image, CppmIndexEncoding::runs);
+    validate_cppm_file(file_path, image);
+
+    const CompressedImageView view(file_path);
+    EXPECT_GT(view.block_rows(), 0U);
+    EXPECT_LT(view.index_bytes().size(), image.pixel_indices.size());
+    std::vector<uint32_t> row(WIDTH_RUNS);
+    for (const int y : {0, HEIGHT_RUNS / 2, HEIGHT_RUNS - 1}) {
+        view.decode_row(y, row);
+        const auto first = image.pixel_indices.begin() + static_cast<std::ptrdiff_t>(y * WIDTH_RUNS);
+        EXPECT_TRUE(std::equal(row.begin(), row.end(), first));
+    }
+    const std::vector<size_t> histogram = view.palette_histogram();
+    EXPECT_EQ(std::accumulate(histogram.begin(), histogram.end(), size_t{0}), image.pixel_indices.size());
+}
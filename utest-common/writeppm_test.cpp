@@ -65,3 +65,37 @@ TEST(BinaryIO, WritePPM) {
         std::cerr << "Error: Unable to delete the file " << test_file_path << '\n';
     }
 }
+
+TEST(BinaryIO, WritePPM16BitBigEndian) {
+    constexpr int MaxColor16 = 65535;
+    Image image;
+    image.width = 2;
+    image.height = 1;
+    image.max_color_value = MaxColor16;
+    image.pixels = {
+        {.r=0x1234, .g=0xABCD, .b=0x00FF},
+        {.r=0xFFFF, .g=0x0100, .b=0x0000}
+    };
+
+    const std::string test_file_path = "test_output_16bit.ppm";
+    write_ppm(test_file_path, image);
+
+    std::ifstream file(test_file_path, std::ios::binary);
+    ASSERT_TRUE(file.is_open()) << "Failed to open test file";
+    std::string header;
+    std::getline(file, header);
+    std::getline(file, header);
+    std::getline(file, header);
+    ASSERT_EQ(header, "65535");
+
+    std::vector<uint8_t> raster(12);
+    file.read(reinterpret_cast<char*>(raster.data()), static_cast<std::streamsize>(raster.size()));
+    ASSERT_EQ(file.gcount(), 12);
+    const std::vector<uint8_t> expected = {0x12, 0x34, 0xAB, 0xCD, 0x00, 0xFF, 0xFF, 0xFF, 0x01, 0x00, 0x00, 0x00};
+    EXPECT_EQ(raster, expected);
+
+    file.close();
+    if (int const result = std::remove(test_file_path.c_str()); result != 0) {
+        std::cerr << "Error: Unable to delete the file " << test_file_path << '\n';
+    }
+}
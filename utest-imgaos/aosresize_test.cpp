@@ -2,6 +2,9 @@
 
 #include "imgaos/imageaos.hpp"
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
 
 constexpr static int MAGIC = 255;
 
@@ -30,7 +33,7 @@ TEST(ImageAOSResize, SolidColorResize) {
 
 // Helper function to check if a pixel has the expected color values
 namespace {
-    void CheckPixelColor(const Pixel& pixel, int expected_red, int expected_green, int expected_blue) {
+    void CheckPixelColor(const ImageAOS::Pixel& pixel, int expected_red, int expected_green, int expected_blue) {
         EXPECT_EQ(pixel.R, expected_red);
         EXPECT_EQ(pixel.G, expected_green);
         EXPECT_EQ(pixel.B, expected_blue);
@@ -86,4 +89,69 @@ TEST(ImageAOSResize, LargerResize) {
     EXPECT_NEAR(resized_image.pixels[15].R, 255, 1);
     EXPECT_NEAR(resized_image.pixels[15].G, 255, 1);
     EXPECT_NEAR(resized_image.pixels[15].B, 0, 1);
-}
\ No newline at end of file
+}
+// Streaming resize must match the in-memory resize pixel for pixel
+TEST(ImageAOSResize, StreamingMatchesInMemory) {
+    constexpr int width = 5;
+    constexpr int height = 6;
+    constexpr int new_width = 8;
+    constexpr int new_height = 3;
+    ImageAOS image(width, height);
+    std::ofstream file("test_aos_stream_in.ppm", std::ios::binary);
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        image.pixels[i] = {.R=static_cast<int>((i * 37) % 256), .G=static_cast<int>((i * 91) % 256), .B=static_cast<int>((i * 13) % 256)};
+        file.put(static_cast<char>(image.pixels[i].R)).put(static_cast<char>(image.pixels[i].G)).put(static_cast<char>(image.pixels[i].B));
+    }
+    file.close();
+
+    PpmStripReader reader("test_aos_stream_in.ppm");
+    resize_aos_streaming(reader, "test_aos_stream_out.ppm", new_width, new_height);
+    const ImageAOS expected = resize_aos(image, new_width, new_height);
+
+    const Image streamed = read_ppm("test_aos_stream_out.ppm");
+    ASSERT_EQ(streamed.pixels.size(), expected.pixels.size());
+    for (size_t i = 0; i < expected.pixels.size(); ++i) {
+        CheckPixelColor(expected.pixels[i], streamed.pixels[i].r, streamed.pixels[i].g, streamed.pixels[i].b);
+    }
+    std::remove("test_aos_stream_in.ppm");
+    std::remove("test_aos_stream_out.ppm");
+}
+
+// A caller-held plan gives the same result and must match the image it is used on
+TEST(ImageAOSResize, ExplicitPlan) {
+    constexpr int width = 5;
+    constexpr int height = 3;
+    ImageAOS image(width, height);
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        image.pixels[i] = {.R=static_cast<int>(i), .G=static_cast<int>(2 * i), .B=static_cast<int>(3 * i)};
+    }
+    const ResizePlan plan({.source_width=width, .source_height=height, .new_width=height, .new_height=width,
+                           .method=ResizeMethod::nearest});
+    const ImageAOS planned = resize_aos(image, plan);
+    const ImageAOS expected = resize_aos(image, height, width);
+    for (size_t i = 0; i < expected.pixels.size(); ++i) {
+        EXPECT_EQ(planned.pixels[i].R, expected.pixels[i].R);
+        EXPECT_EQ(planned.pixels[i].B, expected.pixels[i].B);
+    }
+    EXPECT_THROW(static_cast<void>(resize_aos(ImageAOS(height, height), plan)), std::runtime_error);
+}
+
+// The filtered AOS path shares its kernels with SOA, so interleaved pixels
+// must give the same samples as separate planes
+TEST(ImageAOSResize, AreaFilterMatchesPlanes) {
+    constexpr int width = 9;
+    constexpr int height = 7;
+    ImageAOS16 image(width, height);
+    for (size_t i = 0; i < image.pixels.size(); ++i) {
+        image.pixels[i] = {.R=static_cast<uint16_t>(i * 997), .G=static_cast<uint16_t>(i * 13), .B=static_cast<uint16_t>(500 - i)};
+    }
+    const ImageAOS16 resized = resize_aos(image, 4, 3, ResizeMethod::area);
+    ImageAOS16 red_only = image;
+    for (auto& pixel : red_only.pixels) {pixel = {.R=pixel.R, .G=pixel.R, .B=pixel.R};}
+    const ImageAOS16 red_resized = resize_aos(red_only, 4, 3, ResizeMethod::area);
+    for (size_t i = 0; i < resized.pixels.size(); ++i) {
+        EXPECT_EQ(resized.pixels[i].R, red_resized.pixels[i].G);
+    }
+    EXPECT_THROW(static_cast<void>(resize_aos(image, 4, 3, ResizeMethod::bilinear)), std::runtime_error);
+}
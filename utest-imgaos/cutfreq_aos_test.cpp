@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 #include "imgaos/imageaos.hpp"
+#include "helpers/alloc_tracking.hpp"
 
 // Define constants for color values
 static constexpr int MAX_COLOR_VALUE = 255;
@@ -11,10 +12,10 @@ TEST(ImageAOSTest, CutFreq_RemovesInfrequentColors) {
   ImageAOS image(2, 2); // 2x2 image
 
   // Define colors for each pixel
-  image.pixels[0] = Pixel{.R = MAX_COLOR_VALUE, .G = 0, .B = 0}; // Red
-  image.pixels[1] = Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
-  image.pixels[2] = Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
-  image.pixels[3] = Pixel{.R = 0, .G = 0, .B = MAX_COLOR_VALUE}; // Blue
+  image.pixels[0] = ImageAOS::Pixel{.R = MAX_COLOR_VALUE, .G = 0, .B = 0}; // Red
+  image.pixels[1] = ImageAOS::Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
+  image.pixels[2] = ImageAOS::Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
+  image.pixels[3] = ImageAOS::Pixel{.R = 0, .G = 0, .B = MAX_COLOR_VALUE}; // Blue
 
   constexpr int frequency_threshold = 2;
   image.cutfreq(frequency_threshold);
@@ -34,10 +35,10 @@ TEST(ImageAOSTest, CutFreq_NoReplacementWhenAllMeetThreshold) {
   ImageAOS image(2, 2); // 2x2 image
 
   // Define colors for each pixel
-  image.pixels[0] = Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
-  image.pixels[1] = Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
-  image.pixels[2] = Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
-  image.pixels[3] = Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
+  image.pixels[0] = ImageAOS::Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
+  image.pixels[1] = ImageAOS::Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
+  image.pixels[2] = ImageAOS::Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
+  image.pixels[3] = ImageAOS::Pixel{.R = 0, .G = MAX_COLOR_VALUE, .B = 0}; // Green
 
   constexpr int frequency_threshold = 2;
   image.cutfreq(frequency_threshold);
@@ -50,3 +51,54 @@ TEST(ImageAOSTest, CutFreq_NoReplacementWhenAllMeetThreshold) {
   }
 }
 
+
+// Test that the parallel cutfreq gives the same image for any thread count
+TEST(ImageAOSTest, CutFreq_DeterministicAcrossThreadCounts) {
+  constexpr int side = 64;
+  constexpr int channel_range = 24;
+  constexpr int frequency_threshold = 12;
+  ImageAOS image(side, side);
+  for (size_t i = 0; i < image.pixels.size(); ++i) {
+    image.pixels[i] = ImageAOS::Pixel{.R = static_cast<int>((i * 7) % channel_range), .G = static_cast<int>((i * 13) % channel_range),
+                                      .B = static_cast<int>((i * i) % channel_range)};
+  }
+  ImageAOS serial = image;
+  setThreadCount(1);
+  serial.cutfreq(frequency_threshold);
+  constexpr unsigned parallel_threads = 4;
+  setThreadCount(parallel_threads);
+  image.cutfreq(frequency_threshold);
+  setThreadCount(0);
+
+  for (size_t i = 0; i < image.pixels.size(); ++i) {
+    EXPECT_EQ(image.pixels[i].R, serial.pixels[i].R);
+    EXPECT_EQ(image.pixels[i].G, serial.pixels[i].G);
+    EXPECT_EQ(image.pixels[i].B, serial.pixels[i].B);
+  }
+}
+
+// cutfreq works on the pixel array in place: it allocates the color tables,
+// but no copy of the image
+TEST(ImageAOSTest, CutFreq_AllocatesNoImageCopy) {
+  constexpr int side = 256;
+  constexpr int channel_range = 16;
+  constexpr size_t rare_every = 1000;
+  constexpr uint8_t rare_value = 200;
+  constexpr int frequency_threshold = 100;
+  ImageAOS8 image(side, side);
+  for (size_t i = 0; i < image.pixels.size(); ++i) {
+    const auto value = i % rare_every == 0 ? rare_value : static_cast<uint8_t>(i % channel_range);
+    image.pixels[i] = ImageAOS8::Pixel{.R = value, .G = i % rare_every == 0 ? rare_value : uint8_t{0}, .B = i % rare_every == 0 ? rare_value : uint8_t{0}};
+  }
+  setThreadCount(1);
+  setAllocationTracking(true);
+  const AllocationScope scope;
+  image.cutfreq(frequency_threshold);
+  const AllocationTotals totals = scope.totals();
+  setAllocationTracking(false);
+  setThreadCount(0);
+
+  EXPECT_LT(totals.peak_bytes, image.pixels.size() * sizeof(ImageAOS8::Pixel));
+  EXPECT_EQ(image.pixels[0].R, channel_range - 1);  // The rare gray became the closest frequent red
+  EXPECT_EQ(image.pixels[0].G, 0);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "common/binaryio.hpp"
+#include "common/maxlevel.hpp"
+#include "common/pipeline.hpp"
+#include "helpers/stats.hpp"
+#include "imgaos/imageaos.hpp"
+#include "utest-common/test_support.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <variant>
+
+constexpr static int SOURCE_WIDTH = 90;
+constexpr static int SOURCE_HEIGHT = 60;
+constexpr static int NEW_WIDTH = 37;
+constexpr static int NEW_HEIGHT = 71;
+constexpr static int NEW_MAX = 1000;
+
+class PipelineAOSTest : public ::testing::Test {
+protected:
+    std::string input;
+    std::string output;
+
+    void SetUp() override {
+        input = scratch_file("in.ppm");
+        output = scratch_file("out.ppm");
+        write_ppm(input, gradient_image(SOURCE_WIDTH, SOURCE_HEIGHT));
+    }
+
+    void TearDown() override {
+        setStatsEnabled(false);
+        resetStats();
+        std::remove(input.c_str());
+        std::remove(output.c_str());
+    }
+};
+
+// A lone nearest resize from .ppm to .ppm streams and writes what the
+// in-memory resize writes
+TEST_F(PipelineAOSTest, StreamsSingleResize) {
+    const std::array<const char*, 7> args = {"imtool", input.c_str(), output.c_str(),
+                                             "--stats", "resize", "37", "71"};
+    EXPECT_EQ(run_imtool<AosLayout>(static_cast<int>(args.size()), args.data()), 0);
+    EXPECT_NE(statsReport().find(R"("stream.resize": {"calls": 1)"), std::string::npos);
+    EXPECT_EQ(statsReport().find("layout.convert_in"), std::string::npos);
+
+    const auto source = AosLayout::from_interleaved(gradient_image(SOURCE_WIDTH, SOURCE_HEIGHT));
+    const Image8 expected = AosLayout::to_interleaved(AosLayout::resize(source, NEW_WIDTH, NEW_HEIGHT, ResizeMethod::nearest), MAGICNUMB);
+    expect_same_pixels(std::get<Image8>(read_ppm_native(output)), expected);
+}
+
+// A lone maxlevel streams too, here widening the file to two bytes per sample
+TEST_F(PipelineAOSTest, StreamsSingleMaxlevel) {
+    const std::array<const char*, 6> args = {"imtool", input.c_str(), output.c_str(),
+                                             "--stats", "maxlevel", "1000"};
+    EXPECT_EQ(run_imtool<AosLayout>(static_cast<int>(args.size()), args.data()), 0);
+    EXPECT_NE(statsReport().find(R"("stream.maxlevel": {"calls": 1)"), std::string::npos);
+
+    const Image16 expected = maxlevel_image<uint16_t>(gradient_image(SOURCE_WIDTH, SOURCE_HEIGHT), NEW_MAX);
+    expect_same_pixels(std::get<Image16>(read_ppm_native(output)), expected);
+}
+
+// Other filters and chains of stages run in memory
+TEST_F(PipelineAOSTest, RunsOtherJobsInMemory) {
+    const std::array<const char*, 8> args = {"imtool", input.c_str(), output.c_str(),
+                                             "--stats", "resize", "37", "71", "area"};
+    EXPECT_EQ(run_imtool<AosLayout>(static_cast<int>(args.size()), args.data()), 0);
+    EXPECT_EQ(statsReport().find("stream.resize"), std::string::npos);
+    EXPECT_NE(statsReport().find(R"("layout.convert_in": {"calls": 1)"), std::string::npos);
+}
@@ -1,7 +1,10 @@
 // imagesoa_test.cpp
 
 #include <gtest/gtest.h>
+#include "common/maxlevel.hpp"
 #include "imgsoa/imagesoa.hpp"
+#include "helpers/alloc_tracking.hpp"
+#include "helpers/helpers.hpp"
 
 // Define a constant for the max color value
 static constexpr int MAX_COLOR_VALUE = 255;
@@ -48,3 +51,52 @@ TEST(ImageSOATest, CutFreq_NoReplacementWhenAllMeetThreshold) {
   }
 }
 
+
+// Planes rescaled through the lookup table must match the interleaved path
+TEST(ImageSOATest, Maxlevel_MatchesInterleaved) {
+  constexpr int width = 5;
+  constexpr int height = 3;
+  constexpr int wide_max = 1023;
+  constexpr int step = 67;
+  Image16 interleaved{.width=width, .height=height, .max_color_value=wide_max, .pixels={}};
+  for (int i = 0; i < width * height; ++i) {
+    interleaved.pixels.push_back({.r=static_cast<uint16_t>(i * step), .g=static_cast<uint16_t>(wide_max - i),
+                                  .b=static_cast<uint16_t>((i * step) % wide_max)});
+  }
+  const ImageSOA8 planes = maxlevel_soa<uint8_t>(to_soa(interleaved), wide_max, MAX_COLOR_VALUE);
+  const Image8 expected = maxlevel_image<uint8_t>(interleaved, MAX_COLOR_VALUE);
+  const Image8 actual = from_soa(planes, MAX_COLOR_VALUE);
+  for (size_t i = 0; i < expected.pixels.size(); ++i) {
+    EXPECT_EQ(actual.pixels[i].r, expected.pixels[i].r);
+    EXPECT_EQ(actual.pixels[i].g, expected.pixels[i].g);
+    EXPECT_EQ(actual.pixels[i].b, expected.pixels[i].b);
+  }
+}
+
+// cutfreq works on the channel planes in place: it allocates the color
+// tables, but no copy of the image
+TEST(ImageSOATest, CutFreq_AllocatesNoImageCopy) {
+  constexpr int side = 256;
+  constexpr int channel_range = 16;
+  constexpr size_t rare_every = 1000;
+  constexpr uint8_t rare_value = 200;
+  constexpr int frequency_threshold = 100;
+  ImageSOA8 image(side, side);
+  for (size_t i = 0; i < image.R.size(); ++i) {
+    const bool rare = i % rare_every == 0;
+    image.R[i] = rare ? rare_value : static_cast<uint8_t>(i % channel_range);
+    image.G[i] = rare ? rare_value : 0;
+    image.B[i] = rare ? rare_value : 0;
+  }
+  setThreadCount(1);
+  setAllocationTracking(true);
+  const AllocationScope scope;
+  image.cutfreq(frequency_threshold);
+  const AllocationTotals totals = scope.totals();
+  setAllocationTracking(false);
+  setThreadCount(0);
+
+  EXPECT_LT(totals.peak_bytes, 3 * image.R.size());
+  EXPECT_EQ(image.R[0], channel_range - 1);  // The rare gray became the closest frequent red
+  EXPECT_EQ(image.G[0], 0);
+}
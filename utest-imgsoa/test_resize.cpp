@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <gtest/gtest.h>
+#include "helpers/helpers.hpp"
 #include "imgsoa/imagesoa.hpp"
 
 constexpr static int SIX = 6;
@@ -109,3 +113,151 @@ TEST(ImageSOAResizeTest, SolidColorResize) {
         EXPECT_EQ(resized_image.B[i], 200);
     }
 }
+
+// Streaming resize must match the in-memory resize pixel for pixel; an
+// 8-bit file is resized with 8-bit channels on both paths
+TEST(ImageSOAResizeTest, StreamingMatchesInMemory) {
+    constexpr int width = 7;
+    constexpr int height = 5;
+    ImageSOA8 image(width, height);
+    std::ofstream file("test_soa_stream_in.ppm", std::ios::binary);
+    file << "P6\n" << width << " " << height << "\n255\n";
+    for (size_t i = 0; i < image.R.size(); ++i) {
+        image.R[i] = static_cast<uint8_t>((i * 37) % 256);
+        image.G[i] = static_cast<uint8_t>((i * 91) % 256);
+        image.B[i] = static_cast<uint8_t>((i * 13) % 256);
+        file.put(static_cast<char>(image.R[i])).put(static_cast<char>(image.G[i])).put(static_cast<char>(image.B[i]));
+    }
+    file.close();
+
+    PpmStripReader reader("test_soa_stream_in.ppm");
+    resize_soa_streaming(reader, "test_soa_stream_out.ppm", SIX, NINE);
+    const ImageSOA8 expected = image.resize_soa(SIX, NINE);
+
+    const Image streamed = read_ppm("test_soa_stream_out.ppm");
+    ASSERT_EQ(streamed.pixels.size(), expected.R.size());
+    for (size_t i = 0; i < expected.R.size(); ++i) {
+        EXPECT_EQ(streamed.pixels[i].r, expected.R[i]);
+        EXPECT_EQ(streamed.pixels[i].g, expected.G[i]);
+        EXPECT_EQ(streamed.pixels[i].b, expected.B[i]);
+    }
+    std::remove("test_soa_stream_in.ppm");
+    std::remove("test_soa_stream_out.ppm");
+}
+
+// 8-bit channels must interpolate exactly like the int channels they replace
+TEST(ImageSOAResizeTest, EightBitMatchesIntChannels) {
+    constexpr int width = 5;
+    constexpr int height = 4;
+    ImageSOA image(width, height);
+    ImageSOA8 narrow(width, height);
+    for (size_t i = 0; i < image.R.size(); ++i) {
+        image.R[i] = static_cast<int>((i * 37) % 256);
+        image.G[i] = static_cast<int>((i * 91) % 256);
+        image.B[i] = static_cast<int>((i * 13) % 256);
+        narrow.R[i] = static_cast<uint8_t>(image.R[i]);
+        narrow.G[i] = static_cast<uint8_t>(image.G[i]);
+        narrow.B[i] = static_cast<uint8_t>(image.B[i]);
+    }
+
+    const ImageSOA expected = image.resize_soa_scalar(NINE, SIX);
+    const ImageSOA8 resized = narrow.resize_soa_scalar(NINE, SIX);
+    ASSERT_EQ(resized.R.size(), expected.R.size());
+    for (size_t i = 0; i < expected.R.size(); ++i) {
+        EXPECT_EQ(resized.R[i], expected.R[i]);
+        EXPECT_EQ(resized.G[i], expected.G[i]);
+        EXPECT_EQ(resized.B[i], expected.B[i]);
+    }
+}
+
+namespace {
+    // The vectorized path may differ from the per-pixel float formula by one level
+    constexpr int RESIZE_TOLERANCE = 1;
+
+    template <typename Channel>
+    BasicImageSOA<Channel> createGradientImage(const int width, const int height, const unsigned max_value) {
+        BasicImageSOA<Channel> image(width, height);
+        for (size_t i = 0; i < image.R.size(); ++i) {
+            image.R[i] = static_cast<Channel>((i * 7919U) % (max_value + 1));
+            image.G[i] = static_cast<Channel>((i * 104729U) % (max_value + 1));
+            image.B[i] = static_cast<Channel>(max_value - ((i * 31U) % (max_value + 1)));
+        }
+        return image;
+    }
+
+    template <typename Channel>
+    void expectMatchesScalar(const BasicImageSOA<Channel>& image, const int new_width, const int new_height) {
+        const BasicImageSOA<Channel> fast = image.resize_soa(new_width, new_height);
+        const BasicImageSOA<Channel> reference = image.resize_soa_scalar(new_width, new_height);
+        ASSERT_EQ(fast.R.size(), reference.R.size());
+        for (size_t i = 0; i < reference.R.size(); ++i) {
+            EXPECT_NEAR(fast.R[i], reference.R[i], RESIZE_TOLERANCE);
+            EXPECT_NEAR(fast.G[i], reference.G[i], RESIZE_TOLERANCE);
+            EXPECT_NEAR(fast.B[i], reference.B[i], RESIZE_TOLERANCE);
+        }
+    }
+}
+
+// Sizes are chosen so rows are not a multiple of the vector width
+TEST(ImageSOAResizeTest, VectorizedMatchesScalar8Bit) {
+    const auto image = createGradientImage<uint8_t>(37, 23, 255);
+    expectMatchesScalar(image, 61, 45);
+    expectMatchesScalar(image, 13, 9);
+}
+
+TEST(ImageSOAResizeTest, VectorizedMatchesScalar16Bit) {
+    const auto image = createGradientImage<uint16_t>(29, 17, 65535);
+    expectMatchesScalar(image, 53, 31);
+    expectMatchesScalar(image, 11, 7);
+}
+
+TEST(ImageSOAResizeTest, VectorizedMatchesScalarIntChannels) {
+    const auto image = createGradientImage<int>(19, 21, 255);
+    expectMatchesScalar(image, 40, 33);
+    expectMatchesScalar(image, 9, 10);
+}
+
+TEST(ImageSOAResizeTest, ParallelMatchesSerial) {
+    const auto image = createGradientImage<uint16_t>(97, 211, 65535);
+    setThreadCount(1);
+    const ImageSOA16 serial = image.resize_soa(53, 397);
+    constexpr unsigned parallel_threads = 8;
+    setThreadCount(parallel_threads);
+    const ImageSOA16 parallel = image.resize_soa(53, 397);
+    setThreadCount(0);
+
+    EXPECT_EQ(parallel.R, serial.R);
+    EXPECT_EQ(parallel.G, serial.G);
+    EXPECT_EQ(parallel.B, serial.B);
+}
+
+// Halving with the area filter averages each 2x2 block exactly
+TEST(ImageSOAResizeTest, AreaFilterAveragesBlocks) {
+    ImageSOA8 image(4, 2);
+    image.R = {10, 20, 30, 50, 30, 40, 70, 90};
+    image.G.assign(image.R.size(), HUND);
+    image.B.assign(image.R.size(), 0);
+    const ImageSOA8 resized = image.resize_soa(2, 1, ResizeMethod::area);
+
+    EXPECT_EQ(resized.R, (std::vector<uint8_t>{25, 60}));
+    EXPECT_EQ(resized.G, (std::vector<uint8_t>{HUND, HUND}));
+    EXPECT_EQ(resized.B, (std::vector<uint8_t>{0, 0}));
+}
+
+// Both filters keep a flat image flat, and the AOS and SOA paths agree
+TEST(ImageSOAResizeTest, LanczosKeepsFlatImageAndClamps) {
+    auto image = createGradientImage<uint16_t>(64, 48, 65535);
+    std::ranges::fill(image.G, static_cast<uint16_t>(TWOHUND));
+    const ImageSOA16 resized = image.resize_soa(NINE, SIX, ResizeMethod::lanczos3);
+    for (const uint16_t value : resized.G) {EXPECT_EQ(value, TWOHUND);}
+    // A hard edge rings past the channel range and must be clamped, not wrapped
+    ImageSOA8 edge(8, 1);
+    edge.R = {0, 0, 0, 0, 255, 255, 255, 255};
+    edge.G = edge.R;
+    edge.B = edge.R;
+    const ImageSOA8 upscaled = edge.resize_soa(32, 1, ResizeMethod::lanczos3);
+    EXPECT_EQ(upscaled.R.front(), 0);
+    EXPECT_EQ(upscaled.R.back(), 255);
+    constexpr size_t dark_side = 14;
+    for (size_t i = 0; i < dark_side; ++i) {EXPECT_LT(upscaled.R[i], HUND);}
+}